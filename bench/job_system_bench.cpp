@@ -0,0 +1,149 @@
+// job_system_bench：JobSystem 的微基准
+//
+// 用法：job_system_bench [--iterations N] [--workers N]
+// 报告：
+//   - 空作业的提交与完成开销（JobSystem 对比加锁队列的 ThreadPool）
+//   - 依赖链上每一跳的延迟（RunAfter）
+//   - ParallelFor 在均匀与不均匀负载下相对单线程的加速比，以及自动分块与每线程一块的静态划分的对比
+// 每项取 N 次中的中位数。
+
+#include "JobSystem.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kEmptyJobs = 100000;
+const int kChainLength = 10000;
+const size_t kElements = size_t(1) << 22;
+
+double MedianMilliseconds(int iterations, const std::function<void()>& run)
+{
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// 每个元素的代价与 weight 成正比，防止编译器把循环优化掉
+float Work(float value, int weight)
+{
+    for (int i = 0; i < weight; i++) {
+        value = std::sqrt(value + 1.0f);
+    }
+    return value;
+}
+
+// 均匀负载每个元素 4 步；不均匀负载集中在末尾 1/8，代价为其余元素的 64 倍
+int Weight(size_t index, bool skewed)
+{
+    if (!skewed) return 4;
+    return index >= kElements - kElements / 8 ? 64 : 1;
+}
+
+void RunChain(JobSystem& jobs, std::atomic<int>& hops)
+{
+    std::vector<std::unique_ptr<JobCounter>> counters(kChainLength);
+    for (std::unique_ptr<JobCounter>& counter : counters) {
+        counter.reset(new JobCounter());
+    }
+    JobCounter start;
+    JobCounter* previous = &start;
+    for (int i = 0; i < kChainLength; i++) {
+        jobs.RunAfter(*previous, [&hops]() { hops++; }, counters[i].get());
+        previous = counters[i].get();
+    }
+    jobs.Wait(*previous);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 20;
+    int workers = -1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--workers" && i + 1 < argc) {
+            workers = std::max(0, std::atoi(argv[++i]));
+        }
+    }
+
+    JobSystem jobs(workers);
+    std::cout << "JobSystem: " << jobs.GetWorkerCount() << " workers + calling thread" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    // 提交与完成开销：作业本身只做一次原子加
+    std::atomic<size_t> executed(0);
+    double jobMs = MedianMilliseconds(iterations, [&]() {
+        JobCounter counter;
+        for (size_t i = 0; i < kEmptyJobs; i++) {
+            jobs.Run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        }
+        jobs.Wait(counter);
+    });
+    double parallelForMs = MedianMilliseconds(iterations, [&]() {
+        jobs.ParallelFor(0, kEmptyJobs, [&executed](size_t begin, size_t end) {
+            executed.fetch_add(end - begin, std::memory_order_relaxed);
+        });
+    });
+    ThreadPool pool(std::max(1, jobs.GetWorkerCount()));
+    double poolMs = MedianMilliseconds(iterations, [&]() {
+        for (size_t i = 0; i < kEmptyJobs; i++) {
+            pool.Submit([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+        }
+        pool.WaitIdle();
+    });
+    std::cout << "Empty jobs (" << kEmptyJobs << "): JobSystem " << jobMs * 1e6 / kEmptyJobs << " ns/job"
+              << ", ThreadPool " << poolMs * 1e6 / kEmptyJobs << " ns/job"
+              << ", ParallelFor " << parallelForMs * 1e6 / kEmptyJobs << " ns/element" << std::endl;
+
+    std::atomic<int> hops(0);
+    double chainMs = MedianMilliseconds(iterations, [&]() { RunChain(jobs, hops); });
+    std::cout << "Dependency chain (" << kChainLength << " jobs): " << chainMs * 1e6 / kChainLength
+              << " ns/hop" << std::endl;
+
+    std::vector<float> values(kElements, 1.0f);
+    for (bool skewed : { false, true }) {
+        auto body = [&values, skewed](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                values[i] = Work(values[i], Weight(i, skewed));
+            }
+        };
+        double serialMs = MedianMilliseconds(iterations, [&]() { body(0, kElements); });
+
+        size_t steals = jobs.GetStealCount();
+        double autoMs = MedianMilliseconds(iterations, [&]() { jobs.ParallelFor(0, kElements, body); });
+        steals = jobs.GetStealCount() - steals;
+
+        std::cout << (skewed ? "Skewed " : "Uniform") << " ParallelFor (" << kElements << " elements): serial "
+                  << serialMs << " ms, auto grain " << autoMs << " ms (x" << std::setprecision(2)
+                  << serialMs / autoMs << ", " << steals / iterations << " steals/run)" << std::setprecision(3)
+                  << std::endl;
+
+        // 每个线程一块的静态划分（与逐线程切分行的写法相同），负载不均时最慢的一块决定总耗时
+        size_t perThread = (kElements + jobs.GetWorkerCount()) / size_t(jobs.GetWorkerCount() + 1);
+        double staticMs = MedianMilliseconds(iterations, [&]() {
+            jobs.ParallelFor(0, kElements, body, perThread);
+        });
+        std::cout << "        one chunk per thread: " << staticMs << " ms (x" << std::setprecision(2)
+                  << serialMs / staticMs << ")" << std::setprecision(3) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+// png_decode_bench：比较 stb_image 与 PNGDecoder 解码同一张 PNG 的耗时
+//
+// 用法：png_decode_bench [--iterations N] [image]
+// 默认图像为 backgrounds/background.png。除原图外，还会用 ImageWriter 重新编码一份
+// 带 lgIX 分段索引的副本，测量按段并行解码的耗时。并行解码使用 JobSystem::Shared()。
+
+#include "PNGDecoder.h"
+#include "ImageWriter.h"
+#include "JobSystem.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+double MedianMilliseconds(int iterations, const std::function<bool()>& run)
+{
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!run()) return -1.0;
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+void Report(const char* name, double ms, int width, int height)
+{
+    if (ms < 0.0) {
+        std::cout << name << ": failed" << std::endl;
+        return;
+    }
+    double megapixels = double(width) * height / 1.0e6;
+    std::cout << name << ": " << ms << " ms (" << megapixels / (ms / 1000.0) << " MP/s)" << std::endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string path = "backgrounds/background.png";
+    int iterations = 10;
+    const int threads = JobSystem::Shared().GetWorkerCount() + 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else {
+            path = arg;
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.empty()) {
+        std::cerr << "Failed to read " << path << std::endl;
+        return 1;
+    }
+
+    int width, height, channels;
+    unsigned char* reference = stbi_load_from_memory(data.data(), int(data.size()), &width, &height, &channels, 4);
+    if (!reference) {
+        std::cerr << "stb_image failed: " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+
+    // 与 stb_image 逐字节比对，保证两条路径输出一致
+    PNGImage image;
+    if (!PNGDecoder::decode(data.data(), data.size(), 4, image) ||
+        std::memcmp(image.pixels.data(), reference, size_t(width) * height * 4) != 0) {
+        std::cerr << "PNGDecoder output differs from stb_image" << std::endl;
+        stbi_image_free(reference);
+        return 1;
+    }
+
+    std::cout << path << " (" << width << "x" << height << ", " << data.size() << " bytes), "
+              << iterations << " iterations, " << threads << " threads" << std::endl;
+
+    Report("stb_image", MedianMilliseconds(iterations, [&]() {
+        int w, h, c;
+        unsigned char* pixels = stbi_load_from_memory(data.data(), int(data.size()), &w, &h, &c, 4);
+        stbi_image_free(pixels);
+        return pixels != nullptr;
+    }), width, height);
+
+    Report("PNGDecoder (1 thread)", MedianMilliseconds(iterations, [&]() {
+        return PNGDecoder::decode(data.data(), data.size(), 4, image, false);
+    }), width, height);
+
+    Report("PNGDecoder (pipelined)", MedianMilliseconds(iterations, [&]() {
+        return PNGDecoder::decode(data.data(), data.size(), 4, image);
+    }), width, height);
+
+    std::vector<unsigned char> segmented;
+    int segmentRows = std::max(16, height / (threads * 4));
+    ImageWriter::encodePNG(width, height, 4, reference, false, segmented, segmentRows);
+    stbi_image_free(reference);
+
+    std::cout << "Segmented copy: " << segmented.size() << " bytes, " << segmentRows << " rows per segment"
+              << std::endl;
+    Report("stb_image (segmented)", MedianMilliseconds(iterations, [&]() {
+        int w, h, c;
+        unsigned char* pixels = stbi_load_from_memory(segmented.data(), int(segmented.size()), &w, &h, &c, 4);
+        stbi_image_free(pixels);
+        return pixels != nullptr;
+    }), width, height);
+    Report("PNGDecoder (segmented, parallel)", MedianMilliseconds(iterations, [&]() {
+        return PNGDecoder::decode(segmented.data(), segmented.size(), 4, image);
+    }), width, height);
+    return 0;
+}
@@ -0,0 +1,296 @@
+// sdf_format_bench：比较各 SDF 存储格式的带宽与折射质量
+//
+// 用法：sdf_format_bench [--ref-height H] [--ref-length L]
+// 在 CPU 上复现 sdf_generator.frag 的圆形距离场编码与 liquid_glass.frag 的 decodeSDFData
+// （双线性采样、2x2 像素块内的屏幕空间导数、最近纹素取法线、R16F 存 distance - 1 且不截断），
+// 玻璃直径取 SDF 分辨率的 3/4
+// （ResolutionForFootprint 选出的分辨率在直径的 1~2 倍之间）。
+// 报告每种格式的纹理大小、每像素纹理读取次数，以及折射带内距离与折射偏移相对未量化结果的误差。
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class Format {
+    RGBA8,
+    R16F,
+    RG8,
+    R8
+};
+
+struct FormatInfo {
+    Format format;
+    const char* name;
+    int bytesPerTexel;
+    int fetchesPerPixel;
+};
+
+const FormatInfo kFormats[] = {
+    { Format::RGBA8, "RGBA8", 4, 1 },
+    { Format::R16F,  "R16F",  2, 1 },
+    { Format::RG8,   "RG8",   2, 2 },
+    { Format::R8,    "R8",    1, 5 },
+};
+
+struct Vec2 {
+    float x;
+    float y;
+};
+
+Vec2 Normalize(Vec2 v)
+{
+    float length = std::sqrt(v.x * v.x + v.y * v.y);
+    return length > 0.0f ? Vec2{ v.x / length, v.y / length } : Vec2{ 1.0f, 0.0f };
+}
+
+float QuantizeUnorm8(float v)
+{
+    return std::round(std::min(std::max(v, 0.0f), 1.0f) * 255.0f) / 255.0f;
+}
+
+// 按 IEEE half 的 10 位尾数舍入
+float QuantizeHalf(float v)
+{
+    if (v == 0.0f) return 0.0f;
+    int exponent = std::max(int(std::floor(std::log2(std::fabs(v)))), -14);
+    float step = std::ldexp(1.0f, exponent - 10);
+    return std::round(v / step) * step;
+}
+
+// 与 sdf_generator.frag 的 encodeNormal / liquid_glass.frag 的 decodeNormal 相同
+float EncodeNormal(Vec2 n)
+{
+    float px = n.x / (std::fabs(n.x) + std::fabs(n.y));
+    return n.y >= 0.0f ? (1.0f - px) * 0.25f : 0.5f + (1.0f + px) * 0.25f;
+}
+
+Vec2 DecodeNormal(float t)
+{
+    float x = t < 0.5f ? 1.0f - 4.0f * t : 4.0f * t - 3.0f;
+    float y = 1.0f - std::fabs(x);
+    return Normalize({ x, t < 0.5f ? y : -y });
+}
+
+// sdf_generator.frag 在纹理坐标 uv 处的未量化输出；R16F 不在边缘处截断
+void CircleSDF(float u, float v, bool saturate, float& distance, Vec2& normal)
+{
+    Vec2 p = { (u - 0.5f) * 2.0f, (v - 0.5f) * 2.0f };
+    float normalized = std::max((std::sqrt(p.x * p.x + p.y * p.y) - 0.5f) / 0.5f, -1.0f);
+    if (saturate) normalized = std::min(normalized, 1.0f);
+    distance = (normalized + 1.0f) * 0.5f;
+    normal = Normalize(p);
+}
+
+struct Texture {
+    int size;
+    int channels;
+    std::vector<float> texels;
+
+    float Fetch(int x, int y, int channel) const
+    {
+        x = std::min(std::max(x, 0), size - 1);
+        y = std::min(std::max(y, 0), size - 1);
+        return texels[(size_t(y) * size + x) * channels + channel];
+    }
+
+    // GL_LINEAR + GL_CLAMP_TO_EDGE
+    float Sample(float u, float v, int channel) const
+    {
+        float x = u * size - 0.5f;
+        float y = v * size - 0.5f;
+        int x0 = int(std::floor(x));
+        int y0 = int(std::floor(y));
+        float fx = x - x0;
+        float fy = y - y0;
+        float top = Fetch(x0, y0, channel) * (1.0f - fx) + Fetch(x0 + 1, y0, channel) * fx;
+        float bottom = Fetch(x0, y0 + 1, channel) * (1.0f - fx) + Fetch(x0 + 1, y0 + 1, channel) * fx;
+        return top * (1.0f - fy) + bottom * fy;
+    }
+};
+
+Texture Encode(Format format, int size)
+{
+    Texture texture;
+    texture.size = size;
+    texture.channels = format == Format::RGBA8 ? 3 : (format == Format::RG8 ? 2 : 1);
+    texture.texels.resize(size_t(size) * size * texture.channels);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float distance;
+            Vec2 normal;
+            CircleSDF((x + 0.5f) / size, (y + 0.5f) / size, format != Format::R16F, distance, normal);
+            float* texel = &texture.texels[(size_t(y) * size + x) * texture.channels];
+            switch (format) {
+            case Format::RGBA8:
+                texel[0] = QuantizeUnorm8(distance);
+                texel[1] = QuantizeUnorm8(normal.x * 0.5f + 0.5f);
+                texel[2] = QuantizeUnorm8(normal.y * 0.5f + 0.5f);
+                break;
+            case Format::R16F:
+                texel[0] = QuantizeHalf(distance - 1.0f);
+                break;
+            case Format::RG8:
+                texel[0] = QuantizeUnorm8(distance);
+                texel[1] = QuantizeUnorm8(EncodeNormal(normal));
+                break;
+            case Format::R8:
+                texel[0] = QuantizeUnorm8(distance);
+                break;
+            }
+        }
+    }
+    return texture;
+}
+
+Vec2 NormalFromGradient(Vec2 gradient, float u, float v)
+{
+    if (gradient.x * gradient.x + gradient.y * gradient.y > 1e-12f) return Normalize(gradient);
+    return Normalize({ u - 0.5f, v - 0.5f });
+}
+
+// R8 差分的最小采样间距（纹理坐标），与 liquid_glass.frag 相同
+const float kR8GradientStep = 1.0f / 128.0f;
+
+// 与 liquid_glass.frag 的 centralDifference 相同：一侧已饱和时改用另一侧的单边差分
+float CentralDifference(float center, float low, float high)
+{
+    if (high >= 1.0f) return 2.0f * (center - low);
+    if (low >= 1.0f) return 2.0f * (high - center);
+    return high - low;
+}
+
+struct Quality {
+    double meanDistanceError;
+    double maxDistanceError;
+    double meanOffsetError;
+    double maxOffsetError;
+    size_t pixels;
+};
+
+// 折射偏移，与 liquid_glass.frag 相同（scale = 1）
+float RefractionOffset(float distance, float refHeight, float refLength)
+{
+    float dis = (1.0f - distance) * 50.0f;
+    float offsetVal = refHeight + (dis - refHeight) / (0.0f - refHeight) * (refHeight - refLength - refHeight);
+    return dis - offsetVal;
+}
+
+Quality Measure(Format format, const Texture& texture, int diameter, float refHeight, float refLength)
+{
+    // 先对整块屏幕解码距离，导数按 2x2 像素块求差（与 GPU 的 dFdx/dFdy 一致）
+    std::vector<float> distances(size_t(diameter) * diameter);
+    for (int y = 0; y < diameter; y++) {
+        for (int x = 0; x < diameter; x++) {
+            float distance = texture.Sample((x + 0.5f) / diameter, (y + 0.5f) / diameter, 0);
+            distances[size_t(y) * diameter + x] = format == Format::R16F ? distance + 1.0f : distance;
+        }
+    }
+
+    Quality quality = { 0.0, 0.0, 0.0, 0.0, 0 };
+    float step = std::max(1.0f / texture.size, kR8GradientStep);
+    for (int y = 0; y < diameter; y++) {
+        for (int x = 0; x < diameter; x++) {
+            float u = (x + 0.5f) / diameter;
+            float v = (y + 0.5f) / diameter;
+            float exactDistance;
+            Vec2 exactNormal;
+            CircleSDF(u, v, true, exactDistance, exactNormal);
+            float distance = distances[size_t(y) * diameter + x];
+
+            Vec2 normal = { 1.0f, 0.0f };
+            switch (format) {
+            case Format::RGBA8:
+                normal = { (texture.Sample(u, v, 1) - 0.5f) * 2.0f, (texture.Sample(u, v, 2) - 0.5f) * 2.0f };
+                break;
+            case Format::R16F: {
+                int qx = x & ~1;
+                int qy = y & ~1;
+                int nx = std::min(qx + 1, diameter - 1);
+                int ny = std::min(qy + 1, diameter - 1);
+                float dx = distances[size_t(y) * diameter + nx] - distances[size_t(y) * diameter + qx];
+                float dy = distances[size_t(ny) * diameter + x] - distances[size_t(qy) * diameter + x];
+                normal = NormalFromGradient({ dx, dy }, u, v);
+                break;
+            }
+            case Format::RG8: {
+                int tx = std::min(int(u * texture.size), texture.size - 1);
+                int ty = std::min(int(v * texture.size), texture.size - 1);
+                normal = DecodeNormal(texture.Fetch(tx, ty, 1));
+                break;
+            }
+            case Format::R8: {
+                float dx = CentralDifference(distance, texture.Sample(u - step, v, 0), texture.Sample(u + step, v, 0));
+                float dy = CentralDifference(distance, texture.Sample(u, v - step, 0), texture.Sample(u, v + step, 0));
+                normal = NormalFromGradient({ dx, dy }, u, v);
+                break;
+            }
+            }
+
+            // 只统计折射带：未被丢弃且 dis < ref_height
+            float exactDis = (1.0f - exactDistance) * 50.0f;
+            if (exactDistance >= 0.99999f || exactDis >= refHeight) continue;
+
+            double distanceError = std::fabs(distance - exactDistance) * 50.0;
+            float exactOffset = RefractionOffset(exactDistance, refHeight, refLength);
+            float offset = RefractionOffset(distance, refHeight, refLength);
+            double ex = normal.x * offset - exactNormal.x * exactOffset;
+            double ey = normal.y * offset - exactNormal.y * exactOffset;
+            double offsetError = std::sqrt(ex * ex + ey * ey);
+
+            quality.meanDistanceError += distanceError;
+            quality.maxDistanceError = std::max(quality.maxDistanceError, distanceError);
+            quality.meanOffsetError += offsetError;
+            quality.maxOffsetError = std::max(quality.maxOffsetError, offsetError);
+            quality.pixels++;
+        }
+    }
+    if (quality.pixels > 0) {
+        quality.meanDistanceError /= double(quality.pixels);
+        quality.meanOffsetError /= double(quality.pixels);
+    }
+    return quality;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    float refHeight = 20.0f;
+    float refLength = 30.0f;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--ref-height" && i + 1 < argc) {
+            refHeight = float(std::atof(argv[++i]));
+        } else if (arg == "--ref-length" && i + 1 < argc) {
+            refLength = float(std::atof(argv[++i]));
+        }
+    }
+
+    std::cout << "Refraction height " << refHeight << ", length " << refLength
+              << "; errors in pixels within the refraction band" << std::endl;
+    std::cout << std::fixed;
+
+    for (int size : { 128, 256, 512, 1024 }) {
+        int diameter = size * 3 / 4;
+        std::cout << std::endl << "SDF " << size << "x" << size << ", glass " << diameter << "px" << std::endl;
+        std::cout << "  format  texture KB  fetches/px  dist mean/max    offset mean/max" << std::endl;
+        for (const FormatInfo& info : kFormats) {
+            Texture texture = Encode(info.format, size);
+            Quality quality = Measure(info.format, texture, diameter, refHeight, refLength);
+            std::cout << "  " << std::left << std::setw(6) << info.name << std::right
+                      << std::setprecision(1) << std::setw(12) << size_t(size) * size * info.bytesPerTexel / 1024.0
+                      << std::setw(12) << info.fetchesPerPixel
+                      << std::setprecision(3) << std::setw(9) << quality.meanDistanceError
+                      << " / " << std::setw(6) << quality.maxDistanceError
+                      << std::setw(9) << quality.meanOffsetError
+                      << " / " << std::setw(6) << quality.maxOffsetError << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// tile_bin_bench：测量 GlassTileBinner 对大量重叠玻璃面板分桶的耗时与剔除效果
+//
+// 用法：tile_bin_bench [--iterations N] [--width W] [--height H]
+// 在屏幕内按固定种子随机散布 16 到 1024 块面板，报告每帧分桶耗时、每个着色像素平均需要计算的
+// SDF 数（对比不分块时每个像素计算全部面板），以及着色与捕获区域占屏幕的比例。
+
+#include "GlassTileBinner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<GlassTileBounds> MakePanels(int count, int width, int height)
+{
+    unsigned int seed = 12345u;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) / float(1 << 24);
+    };
+
+    std::vector<GlassTileBounds> panels(count);
+    for (GlassTileBounds& panel : panels) {
+        float w = (0.05f + next() * 0.2f) * width;
+        float h = (0.05f + next() * 0.2f) * height;
+        float x = next() * width - w * 0.5f;
+        float y = next() * height - h * 0.5f;
+        panel = { x, y, x + w, y + h, 10.0f + next() * 20.0f };
+    }
+    return panels;
+}
+
+size_t RectArea(const std::vector<GlassTileRect>& rects)
+{
+    size_t area = 0;
+    for (const GlassTileRect& rect : rects) {
+        area += size_t(rect.width) * rect.height;
+    }
+    return area;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 200;
+    int width = 1024;
+    int height = 1536;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--width" && i + 1 < argc) {
+            width = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--height" && i + 1 < argc) {
+            height = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+
+    std::cout << "Screen " << width << "x" << height << ", " << GlassTileBinner::kTileSize << "px tiles" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    GlassTileBinner binner;
+    for (int count : { 16, 64, 256, 1024 }) {
+        std::vector<GlassTileBounds> panels = MakePanels(count, width, height);
+
+        std::vector<double> samples;
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            binner.Bin(width, height, panels.data(), panels.size());
+            samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+
+        // 每个着色 tile 的像素都要遍历该 tile 的列表
+        const std::vector<uint32_t>& ranges = binner.GetTileRanges();
+        double evaluations = 0.0;
+        for (size_t t = 0; t + 1 < ranges.size(); t += 2) {
+            evaluations += double(ranges[t + 1]) * GlassTileBinner::kTileSize * GlassTileBinner::kTileSize;
+        }
+        double shadedPixels = double(binner.GetCoveredTileCount()) * GlassTileBinner::kTileSize * GlassTileBinner::kTileSize;
+        double screen = double(width) * height;
+
+        std::cout << std::setw(5) << count << " panels: bin " << samples[samples.size() / 2] << " ms"
+                  << ", SDFs/pixel " << std::setprecision(1) << evaluations / std::max(1.0, shadedPixels)
+                  << " (untiled " << count << ", max " << binner.GetMaxTileInstances() << ")"
+                  << ", shade " << 100.0 * RectArea(binner.GetShadeRects()) / screen << "% in "
+                  << binner.GetShadeRects().size() << " rects"
+                  << ", capture " << 100.0 * RectArea(binner.GetCaptureRects()) / screen << "% in "
+                  << binner.GetCaptureRects().size() << " rects" << std::setprecision(3) << std::endl;
+    }
+    return 0;
+}
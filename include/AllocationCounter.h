@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief 统计当前线程经 operator new 发生的堆分配次数
+ * 定义 LIQUIDGLASS_COUNT_ALLOCATIONS 时（Debug 构建或 CMake 选项打开的基准构建）替换全局
+ * operator new/delete 进行计数；否则计数恒为 0，检查是空操作。
+ */
+class AllocationCounter {
+public:
+    static bool IsEnabled();
+    static uint64_t GetThreadAllocations();
+};
+
+/**
+ * @brief 记录构造时的分配计数，GetCount 返回此后当前线程发生的分配次数
+ */
+class AllocationScope {
+public:
+    AllocationScope() : m_start(AllocationCounter::GetThreadAllocations()) {}
+    uint64_t GetCount() const { return AllocationCounter::GetThreadAllocations() - m_start; }
+
+    /**
+     * @brief 作用域内发生过堆分配时打印位置并中止程序，用于捕获稳态帧循环中的回归
+     */
+    void ExpectNone(const char* what) const;
+
+private:
+    uint64_t m_start;
+};
@@ -2,31 +2,28 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include "RenderGraph.h"
 
+/**
+ * @brief 计算玻璃覆盖的屏幕区域，并把该区域从源图像拷贝到渲染图中的临时纹理
+ * 捕获纹理由渲染图分配，没有 pass 读取时整个拷贝会被剔除
+ */
 class BackgroundCapture {
 public:
     BackgroundCapture();
     ~BackgroundCapture();
     bool Initialize(int screenWidth, int screenHeight);
-    void BeginCapture();
-    void BeginCapture(const glm::vec2& glassPosition, const glm::vec2& glassSize);
-    void EndCapture();
-    GLuint GetCaptureTexture() const { return m_captureTexture; }
+    // 屏幕尺寸变化后重置为整屏捕获，下一次 UpdateCaptureRegion 按新尺寸计算
+    void SetScreenSize(int screenWidth, int screenHeight);
+    // 添加拷贝 pass，返回捕获纹理
+    RenderResource AddPass(RenderGraph& graph, RenderResource source) const;
     void SetCaptureRegion(int x, int y, int width, int height);
     void UpdateCaptureRegion(const glm::vec2& glassPosition, const glm::vec2& glassSize);
-    void SetBackgroundTexture(GLuint texture) { m_backgroundTexture = texture; }
     void Cleanup();
     int GetCaptureWidth() const { return m_captureWidth; }
     int GetCaptureHeight() const { return m_captureHeight; }
 
 private:
-    bool CreateFramebuffer();
-    void SetupCaptureViewport(int x, int y, int width, int height);
-
-    GLuint m_fbo;
-    GLuint m_captureTexture;
-    GLuint m_rbo;
-    GLuint m_backgroundTexture;
     int m_screenWidth;
     int m_screenHeight;
     int m_captureX;
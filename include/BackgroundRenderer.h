@@ -3,28 +3,66 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
+#include <future>
+#include "ContextVertexArray.h"
+#include "RenderGraph.h"
+
+class TextureUploader;
 
 class BackgroundRenderer {
 public:
     BackgroundRenderer();
     ~BackgroundRenderer();
     bool Initialize();
+    /**
+     * @brief 加载背景
+     * 设置了上传线程且已有背景可显示时，解码与上传在上传线程进行，新纹理就绪前继续显示旧背景；
+     * 启动时（还没有背景）同步加载
+     */
     void LoadBackground(const std::string& imagePath);
     void Render(const glm::mat4& projection, const glm::mat4& view);
+    // 添加把背景绘制到 target 的 pass
+    void AddPass(RenderGraph& graph, RenderResource target, const glm::mat4& projection, const glm::mat4& view);
     void Cleanup();
-    void SetScreenSize(int width, int height);
     GLuint GetBackgroundTexture() const { return m_texture; }
+    // 背景纹理每变化一次加一，供缓存判断背景内容是否改变（纹理名删除后可能被复用）；
+    // 全屏绘制与尺寸无关，各视图的尺寸由缓存键中的目标大小区分
+    int GetContentVersion() const { return m_contentVersion; }
+    // 开启后，未预转换的背景会在后台线程压缩为 BC1 容器，完成后替换当前纹理
+    void SetCompressTextures(bool enabled) { m_compressTextures = enabled; }
+    void SetUploader(TextureUploader* uploader) { m_uploader = uploader; }
+    // 取走已上传完成的背景与压缩结果，返回本次是否换上了新纹理
+    bool Update();
 
 private:
+    struct PendingCompression {
+        int generation;
+        std::string containerPath;
+        std::future<bool> result;
+    };
+
+    struct PendingUpload {
+        int ticket;
+        int generation;
+        std::string path;
+        bool compressed;
+    };
+
     void CreateFullscreenQuad();
     void LoadShader();
+    void StartCompression(const std::string& imagePath, const std::string& containerPath);
 
-    GLuint m_VAO;
+    ContextVertexArray m_VAO;
     GLuint m_VBO;
     GLuint m_EBO;
     GLuint m_shaderProgram;
     GLuint m_texture;
-    int m_screenWidth;
-    int m_screenHeight;
     bool m_initialized;
+    bool m_compressTextures;
+    int m_generation;
+    int m_contentVersion;
+    std::vector<PendingCompression> m_pendingCompressions;
+    TextureUploader* m_uploader;
+    std::vector<PendingUpload> m_pendingUploads;
 };
\ No newline at end of file
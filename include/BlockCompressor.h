@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief BC1 (DXT1) 块压缩器
+ * 每个 4x4 块压缩为 8 字节（4 bpp，RGBA8 的 1/8）。端点由主成分分析加一次最小二乘
+ * 精化得到，调色板索引选择在 SSE2 可用时使用 SIMD。只编码不透明颜色，alpha 被丢弃。
+ */
+class BlockCompressor {
+public:
+    static size_t BC1Size(uint32_t width, uint32_t height);
+
+    /**
+     * @brief 压缩整张 RGBA8 图像，按块行划分到多个线程
+     * @param threadCount 线程数，0 表示使用全部硬件线程
+     */
+    static void CompressBC1(const unsigned char* rgba, uint32_t width, uint32_t height,
+                            unsigned char* out, int threadCount = 0);
+
+    /**
+     * @brief 压缩单个块
+     * @param block 16 个 RGBA8 像素，行优先
+     */
+    static void CompressBC1Block(const unsigned char* block, unsigned char* out);
+
+    /**
+     * @brief 解压为 RGBA8，用于驱动不支持 S3TC 时的回退路径
+     */
+    static void DecompressBC1(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgba);
+};
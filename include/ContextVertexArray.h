@@ -0,0 +1,42 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <functional>
+#include <vector>
+
+struct GLFWwindow;
+
+/**
+ * @brief 在同一共享组的多个上下文中使用的顶点数组
+ * 缓冲、纹理和着色器程序在共享组内共享，VAO（以及 FBO、查询对象）只属于创建它的上下文。
+ * 每个上下文第一次 Bind 时在该上下文中创建 VAO，并调用 setup 绑定共享的缓冲、设置顶点属性。
+ * Cleanup 只能删除当前上下文的 VAO，其他上下文的留待该上下文下次调用 ReleaseOrphans 时删除。
+ */
+class ContextVertexArray {
+public:
+    // 在 VAO 已绑定时调用
+    typedef std::function<void()> Setup;
+
+    ContextVertexArray();
+    ~ContextVertexArray();
+    ContextVertexArray(const ContextVertexArray&) = delete;
+    ContextVertexArray& operator=(const ContextVertexArray&) = delete;
+
+    // 保存 setup，并为当前上下文创建 VAO
+    void Initialize(const Setup& setup);
+    // 绑定当前上下文的 VAO，首次使用时创建
+    void Bind() const;
+    void Cleanup();
+
+    // 删除其他上下文 Cleanup 时留下的、属于当前上下文的 VAO；每个上下文切换为当前后调用
+    static void ReleaseOrphans();
+
+private:
+    struct Entry {
+        GLFWwindow* context;
+        GLuint vao;
+    };
+
+    Setup m_setup;
+    mutable std::vector<Entry> m_entries;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+
+struct GLFWwindow;
+
+// 像素矩形，GL 窗口坐标（原点在左下角）
+struct ScreenRect {
+    int x;
+    int y;
+    int width;
+    int height;
+
+    bool IsEmpty() const { return width <= 0 || height <= 0; }
+};
+
+/**
+ * @brief 逐帧记录屏幕上发生变化的区域，按后台缓冲的年龄算出需要重绘的矩形
+ * 后台缓冲保留了 age 帧之前的内容时，只需重绘本帧与之前 age - 1 帧损伤的并集；
+ * 年龄未知（平台不支持 buffer_age）、超过记录的帧数或整屏失效时退化为整帧重绘。
+ * 损伤用单个包围矩形表示，对一块移动的玻璃足够紧凑。
+ */
+class DamageTracker {
+public:
+    static const int kMaxBufferAge = 4;
+
+    DamageTracker();
+
+    // 尺寸变化后之前的历史全部失效
+    void Reset(int width, int height);
+    // 本帧整屏失效（背景切换、相机移动等）
+    void Invalidate() { m_currentFull = true; }
+    void AddDamage(const ScreenRect& rect);
+
+    /**
+     * @brief 结束本帧的损伤收集，返回本帧需要重绘的区域
+     * @param bufferAge QueryBufferAge 的结果，0 表示内容未定义
+     */
+    ScreenRect EndFrame(int bufferAge);
+
+    bool IsFullRedraw(const ScreenRect& rect) const;
+    // 本次会话累计重绘的像素与整帧重绘应有的像素
+    double GetRedrawnPixels() const { return m_redrawnPixels; }
+    double GetTotalPixels() const { return m_totalPixels; }
+
+    /**
+     * @brief 查询窗口当前后台缓冲的年龄：1 为上一帧的内容，2 为上上帧，0 为未定义
+     * 通过 GLX_EXT_buffer_age / EGL_EXT_buffer_age 查询，需要在绘制前、上下文为当前时调用；
+     * 平台不支持时总是返回 0。查询方式在第一次调用时检测并记在本对象中，每个窗口用各自的 DamageTracker
+     */
+    int QueryBufferAge(GLFWwindow* window);
+
+    static ScreenRect Union(const ScreenRect& a, const ScreenRect& b);
+    static ScreenRect Inflate(const ScreenRect& rect, int margin);
+
+private:
+    enum class BufferAgeSource {
+        Unknown,
+        None,
+        GLX,
+        EGL
+    };
+
+    ScreenRect Clip(const ScreenRect& rect) const;
+
+    int m_width;
+    int m_height;
+    ScreenRect m_current;
+    bool m_currentFull;
+    // 最近几帧的损伤，m_history[0] 为上一帧；空矩形表示没有变化，m_historyFull 标记整屏
+    ScreenRect m_history[kMaxBufferAge];
+    bool m_historyFull[kMaxBufferAge];
+    double m_redrawnPixels;
+    double m_totalPixels;
+    // 检测过查询方式的窗口
+    GLFWwindow* m_bufferAgeWindow;
+    BufferAgeSource m_bufferAgeSource;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 线性分配器：按顺序切分预留的内存块，Reset 时整体回收
+ * 容量不足时临时追加溢出块，下一次 Reset 把容量扩到峰值用量，稳定后不再向堆申请内存。
+ * 只适合存放可平凡析构的数据（实例数据、uniform 暂存、绘制列表）。
+ */
+class LinearArena {
+public:
+    // 不加 explicit：FrameArena 用花括号就地构造数组元素，C++14 下不允许拷贝不可复制的 LinearArena
+    LinearArena(size_t capacity = 256 * 1024);
+    ~LinearArena();
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "LinearArena never runs destructors");
+        T* items = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; i++) {
+            new (items + i) T();
+        }
+        return items;
+    }
+
+    void Reset();
+
+    size_t GetUsed() const { return m_used; }
+    size_t GetCapacity() const { return m_capacity; }
+    size_t GetPeakUsed() const { return m_peakUsed; }
+
+private:
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    unsigned char* m_base;
+    size_t m_capacity;
+    size_t m_offset;
+    // 当前帧的溢出块，Reset 时释放
+    std::vector<unsigned char*> m_overflowBlocks;
+    unsigned char* m_overflowCurrent;
+    size_t m_overflowOffset;
+    size_t m_overflowCapacity;
+    size_t m_used;
+    size_t m_peakUsed;
+};
+
+/**
+ * @brief 双缓冲的帧分配器
+ * BeginFrame 切换到另一块并清空，上一帧分配的数据在本帧内仍然有效（例如仍在被异步读取的暂存数据）
+ */
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 256 * 1024);
+
+    void BeginFrame();
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        return m_arenas[m_current].Allocate(size, alignment);
+    }
+
+    template <typename T>
+    T* AllocateArray(size_t count) { return m_arenas[m_current].template AllocateArray<T>(count); }
+
+    const LinearArena& GetCurrent() const { return m_arenas[m_current]; }
+
+private:
+    LinearArena m_arenas[2];
+    int m_current;
+};
+
+/**
+ * @brief 定长对象池，用于生命周期较长的场景对象
+ * 按块（每块 BlockSize 个对象）向堆申请内存，释放的对象进入空闲链表复用，块在池销毁前不归还。
+ */
+template <typename T, size_t BlockSize = 64>
+class PoolAllocator {
+public:
+    PoolAllocator() : m_freeList(nullptr), m_liveCount(0) {}
+
+    template <typename... Args>
+    T* Create(Args&&... args)
+    {
+        if (!m_freeList) {
+            AddBlock();
+        }
+        Slot* slot = m_freeList;
+        m_freeList = slot->next;
+        m_liveCount++;
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    void Destroy(T* object)
+    {
+        if (!object) return;
+        object->~T();
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = m_freeList;
+        m_freeList = slot;
+        m_liveCount--;
+    }
+
+    // 预先分配到至少 count 个对象的容量
+    void Reserve(size_t count)
+    {
+        while (GetCapacity() < count) {
+            AddBlock();
+        }
+    }
+
+    size_t GetLiveCount() const { return m_liveCount; }
+    size_t GetCapacity() const { return m_blocks.size() * BlockSize; }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    void AddBlock()
+    {
+        std::unique_ptr<Slot[]> block(new Slot[BlockSize]);
+        for (size_t i = BlockSize; i-- > 0;) {
+            block[i].next = m_freeList;
+            m_freeList = &block[i];
+        }
+        m_blocks.push_back(std::move(block));
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> m_blocks;
+    Slot* m_freeList;
+    size_t m_liveCount;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+
+struct GLFWwindow;
+
+enum class FramePacing {
+    VSync,          // 交换间隔 1
+    AdaptiveVSync,  // 交换间隔 -1：赶不上刷新时立即交换（可能撕裂），驱动不支持时退回 VSync
+    Uncapped,       // 交换间隔 0，不限帧
+    Limited,        // 交换间隔 0，按目标帧率睡眠后自旋到截止时间
+    LowLatency,     // VSync，并用 glFenceSync 限制 GPU 上最多 1 帧，等 GPU 完成后才取输入
+    Count
+};
+
+/**
+ * @brief 帧时间直方图，固定 0.5ms 一档，超过上限的计入最后一档
+ */
+class FrameTimeHistogram {
+public:
+    static const int kBucketCount = 80;
+    static constexpr double kBucketMilliseconds = 0.5;
+
+    FrameTimeHistogram();
+
+    void Add(double milliseconds);
+    void Reset();
+
+    size_t GetCount() const { return m_count; }
+    size_t GetBucket(int index) const { return m_buckets[index]; }
+    double GetMean() const { return m_count ? m_total / m_count : 0.0; }
+    double GetMax() const { return m_max; }
+    // 按档位上沿估计，p 取 0~1
+    double GetPercentile(double p) const;
+
+private:
+    size_t m_buckets[kBucketCount];
+    size_t m_count;
+    double m_total;
+    double m_max;
+};
+
+/**
+ * @brief 帧节奏控制，在渲染线程（持有 GL 上下文的线程）使用
+ * 每帧开始时调用 BeginFrame：Limited 模式在这里等到下一个截止时间，LowLatency 模式等上一帧的
+ * 栅栏完成；之后再取输入和时间，画面对应的输入尽可能新。交换缓冲后调用 EndFrame。
+ * 两次 BeginFrame 之间的间隔计入当前模式的直方图；GetDeltaTime 在同步刷新的模式下把间隔
+ * 对齐到刷新周期的整数倍，计时抖动不会传进动画。
+ */
+class FramePacer {
+public:
+    FramePacer();
+    ~FramePacer();
+
+    /**
+     * @param refreshRate 显示器刷新率（Hz），glfwGetVideoMode 只能在主线程调用，由调用方查询后传入
+     */
+    void Initialize(double refreshRate);
+    void SetMode(FramePacing mode, double targetFps = 60.0);
+    FramePacing GetMode() const { return m_mode; }
+
+    // 返回本帧开始的时间（glfwGetTime 时基）
+    double BeginFrame();
+    /**
+     * @param context 主视图的窗口，LowLatency 模式的栅栏在它的上下文中创建，返回时它是当前上下文
+     */
+    void EndFrame(GLFWwindow* context);
+
+    double GetDeltaTime() const { return m_deltaTime; }
+    const FrameTimeHistogram& GetHistogram(FramePacing mode) const { return m_histograms[int(mode)]; }
+
+    static const char* GetModeName(FramePacing mode);
+    static bool ParseMode(const char* name, FramePacing& mode);
+
+private:
+    void WaitUntil(double deadline);
+    void ReleaseFence();
+
+    FramePacing m_mode;
+    double m_refreshInterval;
+    double m_targetInterval;
+    double m_nextDeadline;
+    double m_lastFrameStart;
+    double m_deltaTime;
+    // 模式切换后的第一帧间隔跨越了两种模式，不计入直方图
+    bool m_skipNextSample;
+    GLsync m_fence;
+    void* m_timer;
+    FrameTimeHistogram m_histograms[int(FramePacing::Count)];
+};
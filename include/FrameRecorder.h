@@ -0,0 +1,93 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+
+enum class RecordFormat {
+    Y4M,
+    RawRGBA,
+    PNGSequence
+};
+
+/**
+ * @brief 帧录制器
+ * 通过 N 个 PBO 组成的环形队列异步回读默认帧缓冲，用 fence 判断回读完成，
+ * 像素交给写出线程转为 Y4M / 原始 RGBA 流，或由多个线程并行编码为 PNG 序列
+ */
+class FrameRecorder {
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    /**
+     * @param output 输出路径；"-" 表示标准输出。PNG 序列时为文件名前缀，例如 "frames/frame_"
+     * @param ringSize PBO 数量，即允许在途的回读帧数
+     * @param encoderThreads PNG 编码线程数，0 表示使用全部硬件线程
+     */
+    bool Start(const std::string& output, RecordFormat format, int width, int height,
+               int fps = 60, int ringSize = 3, int encoderThreads = 0);
+    // 在 SwapBuffers 之前调用，发起本帧的异步回读
+    void CaptureFrame();
+    void Stop();
+    bool IsRecording() const { return m_recording; }
+
+    static RecordFormat FormatFromPath(const std::string& path);
+
+private:
+    struct Frame {
+        std::vector<unsigned char> pixels;
+        int index;
+    };
+
+    struct Slot {
+        GLuint pbo;
+        GLsync fence;
+        int frameIndex;
+    };
+
+    bool CreateSlots();
+    void DestroySlots();
+    bool ReadbackSlot(Slot& slot, bool wait);
+    Frame* AcquireFrame();
+    void WorkerLoop();
+    void WriteY4MFrame(const Frame& frame);
+    void WriteRawFrame(const Frame& frame);
+
+    RecordFormat m_format;
+    std::string m_output;
+    FILE* m_file;
+    int m_width;
+    int m_height;
+    int m_fps;
+    bool m_recording;
+
+    std::vector<Slot> m_slots;
+    int m_nextSlot;
+    int m_capturedFrames;
+
+    // 帧缓冲池在 Start 时一次性分配，录制过程中循环复用
+    std::vector<Frame> m_framePool;
+    std::vector<Frame*> m_freeFrames;
+    // 待写出帧的 FIFO，容量等于帧池大小，录制中入队出队不再分配内存
+    std::vector<Frame*> m_pendingFrames;
+    size_t m_pendingHead;
+    size_t m_pendingCount;
+    std::mutex m_mutex;
+    std::condition_variable m_frameReady;
+    std::condition_variable m_frameFree;
+    bool m_stopping;
+    std::vector<std::thread> m_workers;
+    int m_workerCount;
+
+    std::vector<unsigned char> m_yuvBuffer;
+    int m_writtenFrames;
+    std::chrono::steady_clock::time_point m_startTime;
+    double m_stallSeconds;
+    double m_workerSeconds;
+};
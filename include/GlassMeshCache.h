@@ -0,0 +1,78 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include "ContextVertexArray.h"
+
+enum class GlassMeshShape : uint32_t {
+    Disc = 0,
+    BoundingQuad = 1
+};
+
+struct GlassMeshKey {
+    GlassMeshShape shape;
+    int segments;
+
+    uint64_t Hash() const { return (uint64_t(shape) << 32) | uint32_t(segments); }
+    bool operator==(const GlassMeshKey& other) const { return shape == other.shape && segments == other.segments; }
+    bool operator!=(const GlassMeshKey& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 玻璃网格的顶点格式：只有单位网格平面内的位置（z 恒为 0）
+ * 法线恒为 +Z，纹理坐标等于 position + 0.5，都由顶点着色器推导，不占顶点带宽
+ */
+struct GlassVertex {
+    float x;
+    float y;
+};
+
+struct GlassMesh {
+    ContextVertexArray vao;
+    GLuint ebo;
+    GLsizei indexCount;
+    GLenum indexType;
+    int refCount;
+};
+
+/**
+ * @brief 玻璃网格缓存
+ * 按 (形状, 分段数) 共享索引与 VAO，所有 LiquidGlass 实例复用；
+ * 顶点来自编译期生成的表（中心、kRimVertices 个等分的边缘点、包围盒四角），所有网格共用一个 VBO，
+ * 各分段档位按步长从边缘点中取索引。构建网格时不做堆分配，也不保留 CPU 端副本。
+ * 缓冲在共享组内共享，VAO 按上下文创建，多个视图的上下文可以共用同一个缓存。
+ */
+class GlassMeshCache {
+public:
+    static const int kMinSegments = 8;
+    static const int kMaxSegments = 256;
+    // 边缘点个数，是所有分段档位的公倍数
+    static const int kRimVertices = 768;
+
+    GlassMeshCache();
+    ~GlassMeshCache();
+
+    const GlassMesh* Acquire(const GlassMeshKey& key);
+    void Release(const GlassMeshKey& key);
+    void Cleanup();
+    size_t GetMeshCount() const { return m_meshes.size(); }
+
+    /**
+     * @brief 根据屏幕上的投影半径（像素）选择分段数
+     * 保证弦高误差不超过 maxErrorPixels，并量化到固定档位以便实例间共享
+     */
+    static int SegmentsForRadius(float radiusPixels, float maxErrorPixels = 0.5f);
+
+    /**
+     * @brief 计算单位玻璃网格（半径0.5）经 MVP 变换后在屏幕上的半径（像素）
+     */
+    static float ProjectedRadius(const glm::mat4& mvp, int screenWidth, int screenHeight);
+
+private:
+    bool BuildMesh(const GlassMeshKey& key, GlassMesh& mesh);
+
+    std::unordered_map<uint64_t, GlassMesh> m_meshes;
+    GLuint m_vertexBuffer;
+};
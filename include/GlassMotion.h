@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief 玻璃运动的固定步长积分器
+ * 输入线程每次采样只设置移动方向，Advance 按固定步长推进到当前时间，
+ * 移动速度与帧率无关；渲染线程用 Interpolate 在最近两步之间插值，画面不会随步长抖动。
+ */
+class GlassMotion {
+public:
+    /**
+     * @param speed 每秒移动的距离（NDC 单位），按键按住时每个轴单独生效
+     * @param step 积分步长（秒）
+     */
+    GlassMotion(const glm::vec2& position, float speed = 1.2f, double step = 1.0 / 120.0);
+
+    // 各分量取 -1、0、1，对应方向键的组合
+    void SetDirection(const glm::vec2& direction) { m_direction = direction; }
+
+    /**
+     * @brief 按固定步长推进到 time（秒），返回执行的步数
+     * 落后太多时（调试断点、窗口拖动）丢弃多余的时间，避免一次补算过多步
+     */
+    int Advance(double time);
+
+    const glm::vec2& GetPosition() const { return m_position; }
+    const glm::vec2& GetPreviousPosition() const { return m_previousPosition; }
+    double GetStepTime() const { return m_stepTime; }
+    double GetStep() const { return m_step; }
+
+    /**
+     * @brief 在上一步与当前步之间插值
+     * @param stepTime 当前步完成的时间，renderTime 比它晚一个步长时取当前位置
+     */
+    static glm::vec2 Interpolate(const glm::vec2& previous, const glm::vec2& current,
+                                 double stepTime, double step, double renderTime);
+
+private:
+    glm::vec2 m_position;
+    glm::vec2 m_previousPosition;
+    glm::vec2 m_velocity;
+    glm::vec2 m_direction;
+    float m_speed;
+    double m_step;
+    double m_stepTime;
+    bool m_started;
+};
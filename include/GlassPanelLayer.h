@@ -0,0 +1,141 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "ContextVertexArray.h"
+#include "GlassTileBinner.h"
+#include "RenderGraph.h"
+#include "SDFAtlas.h"
+
+class ResolutionManager;
+
+enum class GlassPanelShape {
+    RoundedRect,
+    Circle,
+    Atlas
+};
+
+/**
+ * @brief 一块玻璃面板，位置与尺寸和 LiquidGlass 相同（世界坐标，单位四边形缩放）
+ * cornerRadius 为圆角半径占短边一半的比例，1 为胶囊；圆形取短边为直径；
+ * Atlas 形状的轮廓取自 SDF 图集中的 atlasEntry，条目（含外延）拉伸到整个面板
+ */
+struct GlassPanel {
+    glm::vec2 position;
+    glm::vec2 size;
+    float cornerRadius;
+    float refHeight;
+    float refLength;
+    GlassPanelShape shape;
+    SDFAtlasEntry atlasEntry;
+};
+
+/**
+ * @brief 大量玻璃面板的分块渲染
+ * 每帧把面板投影到屏幕并交给 GlassTileBinner 分桶，tile 列表与实例参数以纹理缓冲上传；
+ * 捕获只拷贝被覆盖的 tile，着色只绘制被覆盖的 tile，片元只计算所在 tile 的 SDF。
+ * 所有面板共用同一份捕获，面板之间不互相折射。
+ * 融合半径大于 0 时改为合成距离场模式：面板参数放在 UBO 中，片元对所在 tile 的面板做多项式
+ * smooth-min，靠近的面板像液体一样连在一起；包围盒距离足以排除的面板跳过精确计算。
+ * 任意轮廓的面板从共享的 SDF 图集采样，所有形状只占一个纹理单元。
+ * 面板与着色器在视图之间共用，分桶结果与上传缓冲放在各视图的 ViewState 中。
+ */
+class GlassPanelLayer {
+public:
+    struct ViewState;
+
+    // 合成距离场模式下 UBO 容纳的面板数（std140 下 12KB）
+    static const size_t kMaxMergedPanels = 256;
+    // 每个面板在实例缓冲中占用的 vec4 个数
+    static const size_t kInstanceStride = 3;
+
+    GlassPanelLayer();
+    ~GlassPanelLayer();
+
+    bool Initialize();
+    void Cleanup();
+
+    size_t AddPanel(const GlassPanel& panel);
+    void SetPanel(size_t index, const GlassPanel& panel) { m_panels[index] = panel; }
+    void ClearPanels() { m_panels.clear(); }
+    size_t GetPanelCount() const { return m_panels.size(); }
+    // smooth-min 的融合半径（像素），0 表示各面板独立绘制
+    void SetMergeRadius(float radius) { m_mergeRadius = radius; }
+    float GetMergeRadius() const { return m_mergeRadius; }
+    /**
+     * @brief 屏幕上某处变化后，面板像素可能随之改变的最大距离（像素）
+     * 即面板的最大折射余量，融合模式下再加上 smooth-min 的影响范围
+     */
+    float GetInfluenceMargin() const;
+    // Atlas 形状的面板从该图集采样；未设置时按圆角矩形绘制
+    void SetAtlas(const SDFAtlas* atlas) { m_atlas = atlas; }
+
+    /**
+     * @brief 按 state 所属视图的尺寸与相机分桶，并添加捕获与着色 pass
+     * pass 只读取 state，须在 graph 执行完毕之前保持有效
+     */
+    void AddPasses(ViewState& state, RenderGraph& graph, RenderResource target,
+                   const glm::mat4& projection, const glm::mat4& view);
+
+private:
+    // 每帧整体重写的纹理缓冲
+    struct TextureBuffer {
+        GLuint buffer;
+        GLuint texture;
+        size_t capacity;
+    };
+
+    struct Program {
+        GLuint id;
+        GLint rectLocation;
+        GLint screenSizeLocation;
+        GLint tilesXLocation;
+    };
+
+    static bool LoadProgram(const char* fragmentPath, Program& program);
+    void BuildInstances(ViewState& state, FrameArena& arena, const glm::mat4& projection, const glm::mat4& view,
+                        int screenWidth, int screenHeight);
+    static void Capture(const ViewState& state, const RenderPassContext& context, RenderResource source,
+                        RenderResource capture);
+    void Shade(ViewState& state, const RenderPassContext& context, RenderResource capture,
+               int screenWidth, int screenHeight) const;
+    static void UploadBuffer(TextureBuffer& buffer, GLenum format, const void* data, size_t bytes);
+    static void DeleteBuffer(TextureBuffer& buffer);
+
+    std::vector<GlassPanel> m_panels;
+    const SDFAtlas* m_atlas;
+
+    float m_mergeRadius;
+    bool m_mergeLimitReported;
+
+    Program m_tiledProgram;
+    Program m_mergedProgram;
+    GLint m_mergeRadiusLocation;
+    ContextVertexArray m_vao;
+};
+
+/**
+ * @brief 面板层在一个视图中的分桶结果与每帧重写的缓冲，每个视图一份
+ */
+struct GlassPanelLayer::ViewState {
+    ViewState();
+    ~ViewState();
+    ViewState(const ViewState&) = delete;
+    ViewState& operator=(const ViewState&) = delete;
+
+    // 删除缓冲，需要共享组内某个上下文为当前
+    void Cleanup();
+
+    // 设置后捕获纹理按其容量分配，窗口尺寸变化时不必逐帧重建；未设置时与目标同尺寸
+    const ResolutionManager* resolution;
+
+    // 本帧的实例数据，从渲染图的帧分配器分配，每个面板 kInstanceStride 个 vec4
+    const glm::vec4* instanceData;
+    size_t instanceCount;
+    GlassTileBinner binner;
+    TextureBuffer tileRanges;
+    TextureBuffer tileInstances;
+    TextureBuffer instances;
+    GLuint elementBuffer;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief 玻璃参数（CPU 参考路径）
+ * 坐标以输出图像像素为单位，原点在左上角
+ */
+struct GlassParams {
+    float centerX = 0.0f;
+    float centerY = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float refHeight = 20.0f;
+    float refLength = 30.0f;
+    float borderWidth = 5.0f;
+    float exposure = 1.0f;
+    float scale = 1.0f;
+};
+
+struct RGBAImage {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @brief 液态玻璃的 CPU 参考渲染器
+ * 逐像素复现 sdf_generator.frag + liquid_glass.frag 的计算，不依赖 OpenGL 上下文，
+ * 供离线批量渲染使用
+ */
+class GlassReferenceRenderer {
+public:
+    typedef void (*RowKernel)(const RGBAImage& src, RGBAImage& dst, const GlassParams& params,
+                              int rowBegin, int rowEnd);
+
+    /**
+     * @brief 计算玻璃覆盖的像素行范围 [rowBegin, rowEnd)
+     */
+    static void GetRowRange(const GlassParams& params, int imageHeight, int& rowBegin, int& rowEnd);
+
+    /**
+     * @brief 按折射参数选择特化的行渲染函数，签名与 RenderRows 相同
+     * 默认参数使用编译期常量版本，其余参数走通用版本；同一作业的各行段应共用一次选择的结果
+     */
+    static RowKernel SelectKernel(const GlassParams& params);
+
+    /**
+     * @brief 在 dst 上绘制 [rowBegin, rowEnd) 行内的玻璃
+     * dst 必须已经包含 src 的副本且尺寸一致；不同行段可以并行调用
+     */
+    static void RenderRows(const RGBAImage& src, RGBAImage& dst, const GlassParams& params,
+                           int rowBegin, int rowEnd);
+
+    /**
+     * @brief 单线程渲染整张图像
+     */
+    static void Render(const RGBAImage& src, RGBAImage& dst, const GlassParams& params);
+};
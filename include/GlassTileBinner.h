@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 玻璃实例在屏幕上的包围盒（像素，GL 窗口坐标，原点在左下角）
+ * margin 为折射采样可能偏出包围盒的最大距离，只影响捕获区域
+ */
+struct GlassTileBounds {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+    float margin;
+};
+
+struct GlassTileRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * @brief 按屏幕 tile 对玻璃实例分桶
+ * 每个 tile 得到覆盖它的实例列表（保持输入顺序，后面的实例在上层），着色器只遍历所在 tile 的列表；
+ * 同时把被覆盖的 tile 合并为矩形，着色只绘制这些矩形，捕获只拷贝按折射余量扩展后的矩形。
+ * 计数、前缀和、填充三趟完成，耗时与实例覆盖的 tile 总数成正比，数组跨帧复用。
+ */
+class GlassTileBinner {
+public:
+    static const int kTileSize = 32;
+
+    GlassTileBinner();
+
+    void Bin(int screenWidth, int screenHeight, const GlassTileBounds* instances, size_t count);
+
+    int GetTilesX() const { return m_tilesX; }
+    int GetTilesY() const { return m_tilesY; }
+    // 每个 tile 两个值：在实例列表中的偏移与数量，按行优先排列
+    const std::vector<uint32_t>& GetTileRanges() const { return m_tileRanges; }
+    const std::vector<uint32_t>& GetTileInstances() const { return m_tileInstances; }
+    const std::vector<GlassTileRect>& GetShadeRects() const { return m_shadeRects; }
+    const std::vector<GlassTileRect>& GetCaptureRects() const { return m_captureRects; }
+    uint32_t GetMaxTileInstances() const { return m_maxTileInstances; }
+    size_t GetCoveredTileCount() const { return m_coveredTiles; }
+
+private:
+    struct TileSpan {
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+    };
+
+    bool ToTileSpan(float minX, float minY, float maxX, float maxY, TileSpan& span) const;
+    void BuildRects(const std::vector<uint8_t>& mask, std::vector<GlassTileRect>& rects);
+
+    int m_screenWidth;
+    int m_screenHeight;
+    int m_tilesX;
+    int m_tilesY;
+    std::vector<TileSpan> m_spans;
+    std::vector<uint32_t> m_tileRanges;
+    std::vector<uint32_t> m_cursors;
+    std::vector<uint32_t> m_tileInstances;
+    std::vector<uint8_t> m_shadeMask;
+    std::vector<uint8_t> m_captureMask;
+    std::vector<GlassTileRect> m_shadeRects;
+    std::vector<GlassTileRect> m_captureRects;
+    uint32_t m_maxTileInstances;
+    size_t m_coveredTiles;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief 图像写出器类
+ * 提供静态方法将 8 位 RGB/RGBA 像素编码为 PNG
+ */
+class ImageWriter {
+public:
+    /**
+     * @brief 将像素编码为 PNG 数据
+     * @param width 图像宽度
+     * @param height 图像高度
+     * @param channels 通道数（3 或 4）
+     * @param pixels 像素数据，行间距为 width * channels
+     * @param flipVertically 为 true 时按自下而上的行序读取（glReadPixels 的输出）
+     * @param out 输出的 PNG 文件内容，会被覆盖
+     * @param segmentRows 大于 0 时每隔这么多行切分为独立压缩的段并写入 lgIX 索引块，
+     *                    PNGDecoder 可以按段并行解码，其他解码器照常读取
+     * @return 成功返回 true
+     */
+    static bool encodePNG(int width, int height, int channels, const unsigned char* pixels,
+                          bool flipVertically, std::vector<unsigned char>& out, int segmentRows = 0);
+
+    /**
+     * @brief 将像素编码为 PNG 并写入文件
+     */
+    static bool writePNG(const std::string& path, int width, int height, int channels,
+                         const unsigned char* pixels, bool flipVertically = false, int segmentRows = 0);
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "WorkStealingDeque.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+/**
+ * @brief 工作窃取作业系统，用于解码、距离场、块压缩等 CPU 阶段
+ * 每个工作线程有一个 Chase-Lev 双端队列：工作线程产生的作业压入自己的队列，空闲时从其他线程的队列顶部窃取。
+ * 非工作线程（渲染线程、上传线程等）提交的作业进入一个加锁的注入队列。
+ * Wait 在计数归零之前让调用线程也执行作业，等待者不会空占一个核心，在作业内部嵌套等待也不会死锁。
+ */
+class JobSystem {
+public:
+    static const int kDequeCapacity = 1024;
+    // ParallelFor 自动分块时每个线程（含调用线程）分到的块数，块数多于线程数时窃取才能摊平负载不均
+    static const int kChunksPerThread = 4;
+
+    typedef std::function<void()> Task;
+    // 处理 [begin, end)
+    typedef std::function<void(size_t begin, size_t end)> RangeTask;
+
+    struct Job;
+
+    /**
+     * @param workerCount 工作线程数；小于 0 时取硬件线程数减一（调用线程在 Wait 中补上），
+     *                    为 0 时所有作业都由等待的线程执行
+     */
+    explicit JobSystem(int workerCount = -1);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // 进程共享的实例，第一次使用时创建
+    static JobSystem& Shared();
+
+    // counter 可为空；不为空时提交即加一，作业执行完减一
+    void Run(const Task& task, JobCounter* counter = nullptr);
+    /**
+     * @brief dependency 归零后才开始执行 task
+     * dependency 归零之前不应再向它添加作业，否则 task 要等到再次归零
+     */
+    void RunAfter(JobCounter& dependency, const Task& task, JobCounter* counter = nullptr);
+    // 阻塞直到 counter 归零，期间执行可取得的作业
+    void Wait(JobCounter& counter);
+
+    /**
+     * @brief 把 [begin, end) 分块并行执行 body，返回时全部完成
+     * 块大小自动取为每个线程约 kChunksPerThread 块，且不小于 minGrain；范围按二分惰性拆分，
+     * 后一半压入队列供窃取，前一半继续拆分，调用线程执行最前面的一块
+     */
+    void ParallelFor(size_t begin, size_t end, const RangeTask& body, size_t minGrain = 1);
+
+    int GetWorkerCount() const { return int(m_workers.size()); }
+    // 本实例累计的成功窃取次数（包括从注入队列取出）
+    size_t GetStealCount() const { return m_stealCount.load(std::memory_order_relaxed); }
+
+private:
+    typedef WorkStealingDeque<Job*, kDequeCapacity> Deque;
+
+    void WorkerLoop(int index);
+    void Schedule(Job* job);
+    Job* FindJob(int index);
+    void Execute(Job* job);
+    void Complete(JobCounter& counter);
+    void ReleaseContinuations(JobCounter& counter);
+    void Wake();
+    void SplitRange(size_t begin, size_t end, size_t grain, const RangeTask& body, JobCounter& counter);
+    int CurrentWorkerIndex() const;
+
+    std::vector<std::unique_ptr<Deque>> m_deques;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_injectedMutex;
+    std::deque<Job*> m_injected;
+    std::atomic<size_t> m_injectedCount;
+
+    // 提交作业时递增，工作线程睡眠前记下，醒来条件是它发生变化，避免丢失唤醒
+    std::atomic<unsigned int> m_epoch;
+    std::atomic<int> m_sleepers;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_stopping;
+    std::atomic<size_t> m_stealCount;
+};
+
+/**
+ * @brief 一组作业的完成计数，同时可作为后续作业的依赖
+ * 须在等待它的作业全部完成之后才能销毁
+ */
+class JobCounter {
+public:
+    JobCounter() : m_pending(0), m_releasing(0), m_continuations(nullptr) {}
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return m_pending.load() == 0 && m_releasing.load() == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<int> m_pending;
+    // 正在归零并释放后续作业的线程数；归零后等待者可能立刻销毁计数，释放期间不能算完成
+    std::atomic<int> m_releasing;
+    // 等待本计数归零的作业，无锁栈
+    std::atomic<JobSystem::Job*> m_continuations;
+};
@@ -5,11 +5,22 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
 #include <string>
+#include <cmath>
+#include "GlassMeshCache.h"
+#include "RenderGraph.h"
+#include "DamageTracker.h"
 
 class BackgroundCapture;
 class SDFGenerator;
 class BackgroundRenderer;
 
+// 玻璃边缘的色散：折射偏移只算一次，R/B 通道按比例缩放偏移后各取一次背景
+enum class GlassDispersion {
+    Off,
+    Capped,  // R/B 从背景的低分辨率 mip 取样，额外带宽有上限
+    Full     // R/B 全分辨率取样，用于和 Capped 对比画质与耗时
+};
+
 struct GlassMaterial {
     glm::vec3 color;
     float transparency;
@@ -21,48 +32,110 @@ public:
     LiquidGlass();
     ~LiquidGlass();
     void Initialize();
+    // 另一个视图的玻璃：与 primary 共用着色器程序（两者的上下文须在同一共享组），不再编译
+    void InitializeShared(const LiquidGlass& primary);
     void Update(float deltaTime);
-    void Render(const glm::mat4& projection, const glm::mat4& view);
+    // 添加背景捕获、SDF 生成和玻璃绘制三个 pass，玻璃绘制到 target
+    void AddPasses(RenderGraph& graph, RenderResource target, const glm::mat4& projection, const glm::mat4& view);
     void Cleanup();
     void SetDistortion(float distortion) { m_distortion = distortion; }
     float GetDistortion() const { return m_distortion; }
     void SetRotationEnabled(bool enabled) { m_rotationEnabled = enabled; }
     bool IsRotationEnabled() const { return m_rotationEnabled; }
+    // 只标记捕获区域失效，由下一次 Update 统一重建，同一帧内多次修改只触发一次
     void SetGlassPosition(const glm::vec2& pos) { 
+        if (pos != m_glassPosition) m_captureDirty = true;
         m_glassPosition = pos; 
-        UpdateBackgroundCapture();
     }
     const glm::vec2& GetGlassPosition() const { return m_glassPosition; }
     void SetGlassSize(const glm::vec2& size) { 
+        if (size != m_glassSize) m_captureDirty = true;
         m_glassSize = size; 
-        UpdateBackgroundCapture();
     }
     const glm::vec2& GetGlassSize() const { return m_glassSize; }
     void SetBackgroundCapture(BackgroundCapture* capture) { m_backgroundCapture = capture; }
+    // 需在 Initialize 之前设置，玻璃着色器按生成器的 SDF 格式编译
     void SetSDFGenerator(SDFGenerator* generator) { m_sdfGenerator = generator; }
     void SetBackgroundRenderer(BackgroundRenderer* renderer) { m_backgroundRenderer = renderer; }
+    void SetMeshCache(GlassMeshCache* cache) { m_meshCache = cache; }
+    // 形状完全由SDF决定时改用包围四边形，片元着色器丢弃轮廓之外的角落；本帧没有 SDF 纹理时仍用圆盘网格
+    void SetSDFDefinesShape(bool enabled) { m_sdfDefinesShape = enabled; }
+    void SetRefraction(float height, float length) {
+        m_refHeight = height;
+        m_refLength = length;
+    }
     void SetScreenSize(int width, int height) { 
         m_screenWidth = width; 
         m_screenHeight = height; 
+        m_captureDirty = true;
+    }
+    /**
+     * @brief 玻璃在目标上覆盖的像素矩形（GL 窗口坐标，外扩一个像素并裁剪到目标）
+     * 玻璃在相机后方或完全在目标之外时返回 false
+     */
+    bool GetScreenRect(const glm::mat4& projection, const glm::mat4& view, int targetWidth, int targetHeight,
+                       ScreenRect& rect) const;
+    // 折射采样可能偏出玻璃边缘的最大距离（像素），色散时蓝色通道偏得更远
+    float GetRefractionMargin() const {
+        float spread = m_dispersion != GlassDispersion::Off ? 1.0f + m_dispersionStrength : 1.0f;
+        return std::fabs(m_refLength - m_refHeight) * spread + 1.0f;
     }
 
+    // Capped 模式下 R/B 取样的 mip 级别：每级纹素数减为 1/4
+    static constexpr float kDispersionCappedLod = 2.0f;
+    /**
+     * @brief 设置色散模式与强度，strength 为 R/B 偏移相对 G 的比例（红光乘 1 - strength，蓝光乘 1 + strength）
+     * 通道间错开不足半个像素的片元不做额外取样
+     */
+    void SetDispersion(GlassDispersion mode, float strength) {
+        m_dispersion = mode;
+        m_dispersionStrength = strength;
+    }
+    GlassDispersion GetDispersion() const { return m_dispersion; }
+    // 各模式下玻璃 pass 的名称，渲染图的 GPU 计时按名称区分
+    static const char* GetPassName(GlassDispersion mode);
+    // 结果缓存的命中与未命中帧数（本次会话累计）
+    size_t GetCacheHits() const { return m_cacheHits; }
+    size_t GetCacheMisses() const { return m_cacheMisses; }
+
 private:
-    void CreatePlane();
-    void SetupBuffers();
+    // 决定玻璃区域合成结果的全部输入
+    struct ResultCacheKey {
+        glm::mat4 mvp;
+        float refHeight;
+        float refLength;
+        GLuint backgroundTexture;
+        int backgroundVersion;
+        int targetWidth;
+        int targetHeight;
+        GlassDispersion dispersion;
+        float dispersionStrength;
+
+        bool operator==(const ResultCacheKey& other) const;
+    };
+
+    glm::mat4 GetModelMatrix() const;
+    static bool ProjectScreenRect(const glm::mat4& mvp, int targetWidth, int targetHeight, ScreenRect& rect);
+    void EnsureCacheTexture();
+    void AddCachePass(RenderGraph& graph, RenderResource target, bool store);
+    void SelectMesh(const glm::mat4& mvp, bool hasSDF);
     void LoadShaders();
     void UpdateBackgroundCapture();
+    void Draw(GLuint backgroundTexture, GLuint sdfTexture, const glm::mat4& projection, const glm::mat4& view);
 
-    GLuint m_VAO;
-    GLuint m_VBO;
-    GLuint m_EBO;
-    GLuint m_vertexCount;
-    GLuint m_indexCount;
-    std::vector<float> m_vertices;
-    std::vector<unsigned int> m_indices;
+    GlassMeshCache* m_meshCache;
+    const GlassMesh* m_mesh;
+    GlassMeshKey m_meshKey;
+    bool m_sdfDefinesShape;
     GLuint m_shaderProgram;
     glm::vec2 m_glassPosition;
     glm::vec2 m_glassSize;
+    bool m_captureDirty;
+    float m_refHeight;
+    float m_refLength;
     float m_distortion;
+    GlassDispersion m_dispersion;
+    float m_dispersionStrength;
     bool m_rotationEnabled;
     BackgroundCapture* m_backgroundCapture;
     SDFGenerator* m_sdfGenerator;
@@ -70,4 +143,14 @@ private:
     GlassMaterial m_material;
     int m_screenWidth;
     int m_screenHeight;
+
+    GLuint m_cacheTexture;
+    int m_cacheCapacityWidth;
+    int m_cacheCapacityHeight;
+    // 玻璃在目标上的像素矩形，缓存纹理只使用左下角同样大小的区域
+    ScreenRect m_cacheRect;
+    ResultCacheKey m_cacheKey;
+    bool m_cacheValid;
+    size_t m_cacheHits;
+    size_t m_cacheMisses;
 };
\ No newline at end of file
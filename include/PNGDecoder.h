@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 解码后的图像，行自上而下紧密排列，可直接交给 glTexImage2D（GL_UNPACK_ALIGNMENT 为 1）
+ */
+struct PNGImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @brief 多线程 PNG 解码器
+ * 调用线程流式 inflate 各 IDAT 块，行反滤波（SSE2 实现 Sub/Up/Avg/Paeth）作为作业在 JobSystem 上
+ * 紧随其后执行，并直接展开为 RGB/RGBA。带 lgIX 分段索引的 PNG（ImageWriter 以 segmentRows 写出）
+ * 各段互不引用，按段用 ParallelFor 并行解码。
+ * 只处理 8 位非隔行图像，其余变体返回 false，调用方应回退到 stb_image。
+ */
+class PNGDecoder {
+public:
+    /**
+     * @brief 解码内存中的 PNG 数据
+     * @param desiredChannels 0 表示按源图选择（带 alpha 为 4，否则为 3），也可指定 3 或 4
+     * @param parallel 为 false 时在调用线程上顺序解码，不使用作业系统
+     * @return 成功返回 true；数据损坏或格式不受支持时返回 false
+     */
+    static bool decode(const unsigned char* data, size_t size, int desiredChannels, PNGImage& image,
+                       bool parallel = true);
+
+    /**
+     * @brief 读取文件并解码
+     */
+    static bool load(const std::string& path, int desiredChannels, PNGImage& image, bool parallel = true);
+
+    static bool isPNG(const unsigned char* data, size_t size);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief 输入线程维护的玻璃状态快照
+ * 渲染线程每帧只取最新的一份，多次移动合并为一次捕获区域更新。
+ * 位置带上一步的值和步进时间，渲染线程据此用 GlassMotion::Interpolate 插值。
+ */
+struct GlassState {
+    glm::vec2 position;
+    glm::vec2 previousPosition;
+    double stepTime;
+    double step;
+    glm::vec2 size;
+    float refHeight;
+    float refLength;
+};
+
+enum class RenderCommandType {
+    UpdateState,
+    SwitchBackground,
+    ToggleRecording,
+    CycleDispersion,
+    CyclePacing,
+    Resize,
+    Quit
+};
+
+/**
+ * @brief 输入线程发给渲染线程的命令，经 SPSCRing 传递，必须可平凡拷贝
+ */
+struct RenderCommand {
+    RenderCommandType type;
+    GlassState state;           // UpdateState
+    int backgroundIndex;        // SwitchBackground
+    int width;                  // Resize
+    int height;
+    int view;                   // Resize：视图序号，0 为主窗口
+};
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "FrameAllocator.h"
+
+typedef int RenderResource;
+const RenderResource kInvalidRenderResource = -1;
+
+struct RenderTextureDesc {
+    int width;
+    int height;
+    GLenum format;  // 内部格式，如 GL_RGBA8、GL_DEPTH24_STENCIL8
+
+    bool operator==(const RenderTextureDesc& other) const {
+        return width == other.width && height == other.height && format == other.format;
+    }
+    bool operator!=(const RenderTextureDesc& other) const { return !(*this == other); }
+};
+
+class RenderGraph;
+
+/**
+ * @brief 执行 pass 时的上下文，把图中的资源句柄解析为本帧实际使用的 GL 对象
+ */
+class RenderPassContext {
+public:
+    GLuint GetTexture(RenderResource resource) const;
+    // 以该资源为颜色附件的 FBO（后台缓冲为 0），用作 glBlitFramebuffer 的读取源
+    GLuint GetFramebuffer(RenderResource resource) const;
+    const RenderTextureDesc& GetDesc(RenderResource resource) const;
+    // 绑定本 pass 写入的目标，并把视口设为目标尺寸
+    void BindTarget() const;
+
+private:
+    friend class RenderGraph;
+    RenderPassContext(RenderGraph& graph, GLuint framebuffer, int width, int height)
+        : m_graph(graph), m_framebuffer(framebuffer), m_width(width), m_height(height) {}
+
+    RenderGraph& m_graph;
+    GLuint m_framebuffer;
+    int m_width;
+    int m_height;
+};
+
+/**
+ * @brief 声明 pass 读写的资源
+ * 每个 pass 最多写入一个颜色目标和一个深度目标
+ */
+class RenderPassBuilder {
+public:
+    RenderPassBuilder& Read(RenderResource resource);
+    RenderPassBuilder& Write(RenderResource resource);
+    // 结果在图外可见（读回、录制），即使没有 pass 读取它的输出也不剔除
+    RenderPassBuilder& SideEffect();
+
+private:
+    friend class RenderGraph;
+    RenderPassBuilder(RenderGraph& graph, int pass) : m_graph(graph), m_pass(pass) {}
+
+    RenderGraph& m_graph;
+    int m_pass;
+};
+
+/**
+ * @brief 帧渲染图
+ * 每帧按顺序添加 pass 并声明读写，Execute 时：
+ * - 从写入导入资源（后台缓冲、外部纹理）或标记了 SideEffect 的 pass 反向追溯，
+ *   剔除输出无人读取的 pass；
+ * - 临时纹理只在首次写入到最后一次读取之间占用实际纹理，生命周期不重叠且格式尺寸相同的
+ *   临时纹理共用同一张；
+ * - 实际纹理和 FBO 跨帧保留，连续几帧未被使用才释放。
+ * GL 驱动自行处理同一纹理先写后读的依赖，图中不需要插入屏障，pass 按添加顺序执行。
+ * 设置了后台缓冲裁剪矩形时，写入后台缓冲的 pass 在裁剪测试下执行，其余 pass 不受影响。
+ * pass 的回调存放在帧分配器中，稳态下整个过程不产生堆分配。
+ */
+class RenderGraph {
+public:
+    // 实际纹理连续这么多帧未被使用就删除（尺寸随玻璃移动变化时旧纹理很快被回收）
+    static const int kTextureRetainFrames = 3;
+    static const int kMaxPassReads = 4;
+    static const int kMaxPassWrites = 2;
+    static const int kProfileLatency = 3;
+    static const int kMaxProfiledPasses = 32;
+
+    RenderGraph();
+    ~RenderGraph();
+
+    // 清空上一帧的 pass 和资源声明，回调从 arena 分配
+    void BeginFrame(FrameArena& arena);
+    // 本帧的帧分配器；pass 回调读取的逐帧数组也从这里分配，执行到时仍然有效
+    FrameArena& GetFrameArena() { return *m_arena; }
+
+    RenderResource ImportBackbuffer(int width, int height);
+    // 尺寸只在有 pass 渲染到该纹理时才需要
+    RenderResource ImportTexture(const char* name, GLuint texture, int width = 0, int height = 0,
+                                 GLenum format = GL_RGBA8);
+    RenderResource CreateTexture(const char* name, const RenderTextureDesc& desc);
+    const RenderTextureDesc& GetDesc(RenderResource resource) const { return m_resources[resource].desc; }
+
+    /**
+     * @brief 添加 pass，execute 的签名为 void(const RenderPassContext&)
+     * 回调会被拷贝到帧分配器中且不会析构，只能按值捕获指针、句柄和矩阵等平凡类型
+     */
+    template <typename Execute>
+    RenderPassBuilder AddPass(const char* name, const Execute& execute)
+    {
+        static_assert(std::is_trivially_destructible<Execute>::value,
+                      "Render pass callbacks live in the frame arena and are never destroyed");
+        void* closure = m_arena->Allocate(sizeof(Execute), alignof(Execute));
+        new (closure) Execute(execute);
+        return AppendPass(name, closure, [](void* callback, const RenderPassContext& context) {
+            (*static_cast<const Execute*>(callback))(context);
+        });
+    }
+
+    /**
+     * @brief 本帧写入后台缓冲的 pass 只更新该矩形（GL 窗口坐标），用于局部重绘
+     * BeginFrame 时恢复为整个缓冲
+     */
+    void SetBackbufferScissor(int x, int y, int width, int height);
+
+    void Execute();
+    void Cleanup();
+
+    struct PassTiming {
+        const char* name;
+        double totalMilliseconds;
+        int samples;
+    };
+
+    /**
+     * @brief 按 pass 名称统计 GPU 耗时
+     * 每个 pass 包在一个 GL_TIME_ELAPSED 查询里，结果在 kProfileLatency 帧之后读取，届时仍未就绪的丢弃，不会阻塞管线；
+     * 同名 pass 的耗时累加在一起；名称指针需在整个统计期间有效（pass 名称都是字符串字面量）
+     */
+    void SetProfiling(bool enabled);
+    bool IsProfiling() const { return m_profiling; }
+    const std::vector<PassTiming>& GetPassTimings() const { return m_passTimings; }
+    // 没有统计到该名称时返回 0
+    double GetAveragePassTime(const char* name) const;
+    // 因结果未就绪而丢弃的查询数
+    int GetDroppedTimingCount() const { return m_droppedTimings; }
+
+    int GetExecutedPassCount() const { return m_executedPasses; }
+    int GetCulledPassCount() const { return m_culledPasses; }
+    size_t GetTextureCount() const { return m_textures.size(); }
+    // 图持有的全部实际纹理占用的显存（字节）
+    size_t GetTextureMemory() const;
+
+private:
+    friend class RenderPassContext;
+    friend class RenderPassBuilder;
+
+    typedef void (*ExecuteFunction)(void* closure, const RenderPassContext& context);
+
+    struct Resource {
+        const char* name;
+        RenderTextureDesc desc;
+        GLuint texture;
+        bool imported;
+        bool backbuffer;
+        bool needed;
+        int firstPass;
+        int lastPass;
+        int physical;
+    };
+
+    struct Pass {
+        const char* name;
+        void* closure;
+        ExecuteFunction execute;
+        RenderResource reads[kMaxPassReads];
+        int readCount;
+        RenderResource writes[kMaxPassWrites];
+        int writeCount;
+        bool sideEffect;
+        bool culled;
+    };
+
+    struct PhysicalTexture {
+        GLuint texture;
+        RenderTextureDesc desc;
+        bool inUse;
+        int lastUsedFrame;
+    };
+
+    struct CachedFramebuffer {
+        GLuint fbo;
+        GLuint color;
+        GLuint depth;
+        int lastUsedFrame;
+    };
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    RenderPassBuilder AppendPass(const char* name, void* closure, ExecuteFunction execute);
+    RenderResource AddResource(const Resource& resource);
+    void Compile();
+    void AcquireTexture(Resource& resource);
+    GLuint GetFramebuffer(GLuint color, GLuint depth);
+    void ReleaseUnused();
+    void CollectTimings(int slot);
+
+    static bool IsDepthFormat(GLenum format);
+
+    FrameArena* m_arena;
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<PhysicalTexture> m_textures;
+    std::vector<CachedFramebuffer> m_framebuffers;
+    int m_frame;
+    bool m_scissorBackbuffer;
+    GLint m_scissor[4];
+    int m_executedPasses;
+    int m_culledPasses;
+
+    bool m_profiling;
+    // 每帧一组查询，环形使用；m_timerNames 记录每个查询对应的 pass
+    GLuint m_timerQueries[kProfileLatency][kMaxProfiledPasses];
+    const char* m_timerNames[kProfileLatency][kMaxProfiledPasses];
+    int m_timerCounts[kProfileLatency];
+    std::vector<PassTiming> m_passTimings;
+    int m_droppedTimings;
+};
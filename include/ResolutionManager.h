@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief 统一管理帧缓冲尺寸，并决定屏幕大小的渲染目标应分配多大
+ * 尺寸变化时立即通知所有监听者（视口、投影、捕获区域、玻璃的屏幕尺寸），各自保持与窗口一致；
+ * 渲染目标的分配尺寸（容量）与窗口尺寸分开：变大时按 kGrowthFactor 几何增长，
+ * 变小时保留原容量，连续 kShrinkCooldownFrames 帧没有再变化才收缩到实际尺寸。
+ * 拖动窗口时尺寸每帧都在变，容量只在越过上限时才变，渲染图里的纹理不必逐帧重建。
+ * 使用容量分配的目标只有左下角 GetWidth() x GetHeight() 的区域有效，采样时按纹素寻址。
+ */
+class ResolutionManager {
+public:
+    static const int kShrinkCooldownFrames = 120;
+    static constexpr float kGrowthFactor = 1.5f;
+
+    typedef std::function<void(int width, int height)> Listener;
+
+    ResolutionManager();
+
+    // 监听者在初始化阶段注册，之后每次尺寸变化按注册顺序调用
+    void AddListener(const Listener& listener) { m_listeners.push_back(listener); }
+
+    /**
+     * @param maxTargetSize 容量上限，通常为 GL_MAX_TEXTURE_SIZE
+     */
+    void Initialize(int width, int height, int maxTargetSize);
+    // 帧缓冲尺寸变化，尺寸未变时什么也不做
+    void Resize(int width, int height);
+    // 每帧调用一次，推进收缩的冷却计时
+    void Update();
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetTargetWidth() const { return m_targetWidth; }
+    int GetTargetHeight() const { return m_targetHeight; }
+
+    size_t GetResizeCount() const { return m_resizeCount; }
+    // 容量变化的次数，即屏幕大小的渲染目标需要重建的次数
+    size_t GetTargetReallocations() const { return m_targetReallocations; }
+
+private:
+    int Grow(int capacity, int required) const;
+    void Notify();
+
+    std::vector<Listener> m_listeners;
+    int m_width;
+    int m_height;
+    int m_targetWidth;
+    int m_targetHeight;
+    int m_maxTargetSize;
+    int m_framesSinceResize;
+    size_t m_resizeCount;
+    size_t m_targetReallocations;
+};
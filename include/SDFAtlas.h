@@ -0,0 +1,94 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+typedef int SDFAtlasEntry;
+const SDFAtlasEntry kInvalidSDFAtlasEntry = -1;
+
+/**
+ * @brief 把多个形状的距离场打包进一个纹理数组，整个场景只需一次纹理绑定
+ * 每页（数组的一层）用 skyline 装箱增量插入；移除条目留下的空位按 guillotine 切分后优先复用，
+ * 整页清空时重置。碎片导致插入失败时保留的 CPU 副本按高度重新装箱，条目编号不变，只是位置改变，
+ * 因此使用者每帧通过 GetUVRect / GetLayer 取位置，不应缓存。
+ * 距离以 R8 存储：0.5 为边缘，向外增大，kSpread 个纹素处饱和；条目四周各留 kSpread 个纹素的外延
+ */
+class SDFAtlas {
+public:
+    static const int kSpread = 8;
+
+    SDFAtlas();
+    ~SDFAtlas();
+
+    bool Initialize(int pageSize = 1024, int maxPages = 4);
+    void Cleanup();
+
+    /**
+     * @brief 从覆盖掩码（非 0 为形状内部）生成距离场并插入
+     * 距离场比掩码每边多 kSpread 个纹素；空间不足时返回 kInvalidSDFAtlasEntry
+     */
+    SDFAtlasEntry InsertMask(const uint8_t* mask, int width, int height);
+    // 插入已按上述方式编码的距离场
+    SDFAtlasEntry Insert(const uint8_t* field, int width, int height);
+    void Remove(SDFAtlasEntry entry);
+
+    // 条目首末纹素中心的归一化坐标 (u0, v0, u1, v1)
+    glm::vec4 GetUVRect(SDFAtlasEntry entry) const;
+    int GetLayer(SDFAtlasEntry entry) const { return m_entries[entry].page; }
+    bool IsValid(SDFAtlasEntry entry) const;
+
+    GLuint GetTexture() const { return m_texture; }
+    int GetPageSize() const { return m_pageSize; }
+    size_t GetEntryCount() const { return m_entries.size() - m_freeEntries.size(); }
+
+    /**
+     * @brief 用精确欧氏距离变换把掩码编码为距离场，输出 (width + 2 * kSpread) x (height + 2 * kSpread)
+     */
+    static void BuildField(const uint8_t* mask, int width, int height, std::vector<uint8_t>& field);
+
+private:
+    struct Rect {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Page {
+        std::vector<Segment> skyline;
+        std::vector<Rect> freeRects;
+        int entryCount;
+    };
+
+    struct Entry {
+        int page;
+        Rect rect;
+        bool inUse;
+        std::vector<uint8_t> field;
+    };
+
+    bool Allocate(int width, int height, int& page, Rect& rect);
+    static bool AllocateFromFree(Page& page, int width, int height, Rect& rect);
+    bool AllocateFromSkyline(Page& page, int width, int height, Rect& rect);
+    bool FitSkyline(const Page& page, size_t index, int width, int height, int& y) const;
+    void ResetPage(Page& page);
+    void Upload(const Entry& entry) const;
+    void Repack();
+
+    GLuint m_texture;
+    int m_pageSize;
+    std::vector<Page> m_pages;
+    std::vector<Entry> m_entries;
+    std::vector<SDFAtlasEntry> m_freeEntries;
+    std::vector<uint8_t> m_scratch;
+    // 上次重新装箱后是否移除过条目，没有移除时重新装箱不会腾出空间
+    bool m_fragmented;
+};
@@ -2,28 +2,61 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include "ContextVertexArray.h"
+#include "RenderGraph.h"
+
+// SDF 纹理的存储格式；编码（sdf_generator.frag）与解码（liquid_glass.frag 的 decodeSDFData）按同一格式编译
+enum class SDFFormat {
+    RGBA8,  // 距离在 R，法线在 GB，A 闲置
+    R16F,   // 半精度距离，法线由屏幕空间导数求出
+    RG8,    // 8 位距离 + 法线按菱形（二维的八面体映射）展开为 8 位参数
+    R8      // 仅 8 位距离，法线由相邻纹素的差分求出
+};
+
+enum class SDFQuality {
+    Low,     // R8，1 字节/纹素
+    Medium,  // RG8，2 字节/纹素
+    High     // R16F，2 字节/纹素，距离精度最高
+};
 
 class SDFGenerator {
 public:
+    static const int kMinResolution = 16;
+    static const int kMaxResolution = 2048;
+
     SDFGenerator();
     ~SDFGenerator();
-    bool Initialize(int width, int height);
-    void GenerateFromTexture(GLuint inputTexture, float threshold = 0.5f);
-    GLuint GetSDFTexture() const { return m_sdfTexture; }
-    void SetSize(int width, int height);
+    bool Initialize(SDFFormat format = SDFFormat::R16F);
+    /**
+     * @brief 添加 SDF 生成 pass，返回 resolution x resolution 的 SDF 纹理
+     * 着色器实际不采样 backgroundTexture 时（解析形状），pass 不声明读取 source，
+     * 渲染图会据此剔除产生 source 的 pass
+     */
+    RenderResource AddPass(RenderGraph& graph, RenderResource source, int resolution, float threshold = 0.5f) const;
+
+    /**
+     * @brief 根据玻璃在屏幕上的直径（像素）选择 SDF 分辨率
+     * 取不小于直径的 2 的幂，采样时缩小不超过 2 倍而不会混叠；
+     * 档位固定，玻璃缩放时渲染图可以复用同规格的纹理
+     */
+    static int ResolutionForFootprint(float diameterPixels);
     void Cleanup();
 
+    SDFFormat GetFormat() const { return m_format; }
+    static SDFFormat FormatForQuality(SDFQuality quality);
+    static GLenum GetInternalFormat(SDFFormat format);
+    // 着色器预处理定义，编码与解码两端都要用它编译
+    static const char* GetShaderDefines(SDFFormat format);
+
 private:
-    bool CreateFramebuffer();
     bool CreateQuad();
     bool LoadShaders();
-    void RenderQuad();
 
-    GLuint m_fbo;
-    GLuint m_sdfTexture;
-    GLuint m_vao;
+    SDFFormat m_format;
+    ContextVertexArray m_vao;
     GLuint m_vbo;
     GLuint m_shaderProgram;
-    int m_width;
-    int m_height;
+    GLint m_sourceLocation;
+    GLint m_resolutionLocation;
+    GLint m_thresholdLocation;
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief 单生产者单消费者无锁环形队列
+ * 生产者与消费者各自缓存对方的下标，只有在看起来满/空时才读取对方的原子变量，
+ * 两侧的下标放在不同的缓存行上以避免伪共享。
+ * @tparam Capacity 容量，必须是 2 的幂
+ */
+template <typename T, size_t Capacity>
+class SPSCRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SPSCRing() : m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0) {}
+
+    // 仅生产者线程调用；队列已满时返回 false
+    bool TryPush(const T& item)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == Capacity) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == Capacity) return false;
+        }
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅消费者线程调用；队列为空时返回 false
+    bool TryPop(T& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) return false;
+        }
+        item = m_items[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    SPSCRing(const SPSCRing&) = delete;
+    SPSCRing& operator=(const SPSCRing&) = delete;
+
+    // 消费者侧
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+    // 生产者侧
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+    alignas(64) T m_items[Capacity];
+};
@@ -12,6 +12,8 @@ class Shader
 public:
     unsigned int ID;
     Shader(const char* vertexPath, const char* fragmentPath);
+    // defines 插入到两个着色器的 #version 行之后，用于按编译期开关特化同一份源码
+    Shader(const char* vertexPath, const char* fragmentPath, const char* defines);
     void use();
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * .lgtex 纹理容器格式（小端）：
+ *   TextureContainerHeader
+ *   TextureContainerLevel[levelCount]
+ *   各级 mip 数据，起始偏移按 kTextureContainerAlignment 对齐，行紧密排列
+ */
+enum class TextureContainerFormat : uint32_t {
+    RGBA8 = 0,
+    RGB8 = 1,
+    BC1 = 2
+};
+
+const uint32_t kTextureContainerVersion = 1;
+const uint32_t kTextureContainerAlignment = 16;
+
+struct TextureContainerHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t levelCount;
+    uint32_t reserved[2];
+};
+
+struct TextureContainerLevel {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+/**
+ * @brief 以只读内存映射方式打开 .lgtex 文件
+ * 各级 mip 的数据指针直接指向映射区，可以不经拷贝交给 glTexImage2D
+ */
+class TextureContainer {
+public:
+    TextureContainer();
+    ~TextureContainer();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return m_data != nullptr; }
+
+    const TextureContainerHeader& GetHeader() const { return *m_header; }
+    TextureContainerFormat GetFormat() const { return TextureContainerFormat(m_header->format); }
+    uint32_t GetLevelCount() const { return m_header->levelCount; }
+    const TextureContainerLevel& GetLevel(uint32_t level) const { return m_levels[level]; }
+    const unsigned char* GetLevelData(uint32_t level) const { return m_data + m_levels[level].offset; }
+
+    // 未压缩格式每像素的字节数；BC1 的源像素为 RGBA8
+    static uint32_t BytesPerPixel(TextureContainerFormat format);
+    static uint64_t LevelSize(TextureContainerFormat format, uint32_t width, uint32_t height);
+
+    /**
+     * @brief 由基础层像素生成完整 mip 链（2x2 盒式滤波）并写出 .lgtex 文件
+     * @param pixels 基础层像素，行紧密排列；RGB8 为 3 通道，RGBA8 与 BC1 为 4 通道
+     */
+    static bool Write(const std::string& path, uint32_t width, uint32_t height,
+                      TextureContainerFormat format, const unsigned char* pixels);
+
+private:
+    TextureContainer(const TextureContainer&) = delete;
+    TextureContainer& operator=(const TextureContainer&) = delete;
+
+    const unsigned char* m_data;
+    size_t m_size;
+    const TextureContainerHeader* m_header;
+    const TextureContainerLevel* m_levels;
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#else
+    int m_fd;
+#endif
+};
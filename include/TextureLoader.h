@@ -15,6 +15,19 @@ public:
      * @return 返回加载的纹理ID，失败返回0
      */
     static GLuint loadTexture(const std::string& path);
+
+    /**
+     * @brief 从预解码的 .lgtex 容器加载纹理
+     * 文件以内存映射方式打开，各级 mip 直接从映射区上传，不经过解码和中间拷贝
+     * @param path 容器文件路径
+     * @return 返回加载的纹理ID，失败返回0
+     */
+    static GLuint loadTextureContainer(const std::string& path);
+
+    /**
+     * @brief 驱动是否支持 BC1 (S3TC DXT1) 压缩纹理
+     */
+    static bool isBC1Supported();
     
     /**
      * @brief 删除纹理
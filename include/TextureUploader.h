@@ -0,0 +1,68 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+/**
+ * @brief 纹理上传线程
+ * 线程持有一个与渲染上下文同一共享组的上下文（主线程创建的隐藏窗口），在其中执行解码与
+ * glTexImage2D / glGenerateMipmap，每次上传之后插入 glFenceSync 并 flush。
+ * 渲染线程用 TryTake 以零超时查询栅栏，只有栅栏已触发的纹理才会交给调用方，帧循环里不再有上传开销。
+ * 新纹理名在渲染上下文中第一次绑定时即可看到上传线程写入的内容。
+ */
+class TextureUploader {
+public:
+    static const int kInvalidTicket = 0;
+
+    // 在上传线程、上传上下文中执行，返回创建的纹理（失败时为 0）
+    typedef std::function<GLuint()> Upload;
+
+    TextureUploader();
+    ~TextureUploader();
+
+    /**
+     * @param context 与渲染上下文共享对象的窗口，只由上传线程设为当前；须在 glewInit 之后调用
+     */
+    bool Initialize(GLFWwindow* context);
+    // 停止线程；已完成但未取走的纹理在上传上下文中删除，排队中的请求丢弃
+    void Cleanup();
+    bool IsRunning() const { return m_thread.joinable(); }
+
+    // 返回票据，之后用 TryTake 查询结果
+    int Submit(const Upload& upload);
+    /**
+     * @brief 上传已完成且 GPU 已执行完毕时返回 true 并取出纹理（可能为 0），票据随即失效
+     * 不阻塞；请求未完成或栅栏未触发时返回 false
+     */
+    bool TryTake(int ticket, GLuint& texture);
+
+private:
+    struct Request {
+        int ticket;
+        Upload upload;
+    };
+
+    struct Completed {
+        int ticket;
+        GLuint texture;
+        GLsync fence;
+    };
+
+    void WorkerLoop();
+
+    GLFWwindow* m_context;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_requestReady;
+    std::deque<Request> m_requests;
+    std::vector<Completed> m_completed;
+    int m_nextTicket;
+    bool m_stopping;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief 简单的固定线程池
+ * 紧急任务插到队首，使流水线的后续阶段优先于新任务执行
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    void Submit(std::function<void()> task, bool urgent = false);
+    // 阻塞直到队列清空且所有任务执行完毕
+    void WaitIdle();
+    int GetThreadCount() const { return int(m_threads.size()); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskReady;
+    std::condition_variable m_idle;
+    int m_activeTasks;
+    bool m_stopping;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Chase-Lev 工作窃取双端队列（固定容量）
+ * 拥有者线程在底部压入与弹出（后进先出，刚拆分出的任务还在缓存里），其他线程从顶部窃取（先进先出，
+ * 窃取到的是最早拆出的、通常也是最大的一块）。只有最后一个元素上拥有者与窃取者才需要比较交换竞争。
+ * 内存序按 Lê 等人给出的 C11 版本。
+ * @tparam T 元素类型，须可以放进 std::atomic（指针）
+ * @tparam Capacity 容量，必须是 2 的幂
+ */
+template <typename T, size_t Capacity>
+class WorkStealingDeque {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    WorkStealingDeque() : m_top(0), m_bottom(0) {}
+
+    // 仅拥有者线程调用；队列已满时返回 false
+    bool TryPush(T item)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= int64_t(Capacity)) return false;
+        m_items[bottom & (Capacity - 1)].store(item, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅拥有者线程调用；队列为空或最后一个元素被窃取时返回 false
+    bool TryPop(T& item)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = m_items[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // 任意线程调用；队列为空或与其他线程竞争失败时返回 false
+    bool TrySteal(T& item)
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) return false;
+
+        item = m_items[top & (Capacity - 1)].load(std::memory_order_relaxed);
+        return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // 近似值，只用于判断是否值得去窃取
+    bool IsEmpty() const
+    {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // 窃取者侧
+    alignas(64) std::atomic<int64_t> m_top;
+    // 拥有者侧
+    alignas(64) std::atomic<int64_t> m_bottom;
+    alignas(64) std::atomic<T> m_items[Capacity];
+};
@@ -12,6 +12,10 @@ uniform float ref_length = 30.0;
 uniform float ref_border_width = 5.0;
 uniform float ref_exposure = 1.0;
 uniform float scale = 1.0;
+// 色散强度：R/B 偏移相对 G 的比例，0 关闭
+uniform float dispersion = 0.0;
+// R/B 取样的 mip 级别，大于 0 时为成本受限模式
+uniform float dispersion_lod = 0.0;
 
 vec4 getColorWithOffset(vec2 coord, vec2 offset) {
     vec2 screenSize = textureSize(backgroundTexture, 0);
@@ -24,16 +28,80 @@ vec4 getColorWithOffset(vec2 coord, vec2 offset) {
     return vec4(rgb, color.a);
 }
 
+// 复用已算好的折射偏移：G 用主取样的结果，R/B 把同一偏移按比例缩放后各取一个通道
+// 分支内没有隐式导数，用 textureLod 显式指定级别
+vec4 applyDispersion(vec4 color, vec2 coord, vec2 offset) {
+    vec2 spread = offset * dispersion;
+    // 通道错开不足半个像素时看不出色散，跳过额外取样
+    if (dispersion <= 0.0 || dot(spread, spread) < 0.25) {
+        return color;
+    }
+    vec2 screenSize = textureSize(backgroundTexture, 0);
+    vec2 redCoord = clamp((coord + offset - spread) / screenSize, 0.0, 1.0);
+    vec2 blueCoord = clamp((coord + offset + spread) / screenSize, 0.0, 1.0);
+    float red = textureLod(backgroundTexture, redCoord, dispersion_lod).r * ref_exposure;
+    float blue = textureLod(backgroundTexture, blueCoord, dispersion_lod).b * ref_exposure;
+    return vec4(red, color.g, blue, color.a);
+}
+
 float linear_map(float x, float y, float a, float b, float tsetnumber) {
     float ratio = (tsetnumber - x) / (y - x);
     return a + ratio * (b - a);
 }
 
-vec4 decodeSDFData(vec4 sdfData) {
+// 径向方向，梯度退化（圆心、距离饱和区）时作为法线
+vec2 fallbackNormal(vec2 uv) {
+    vec2 radial = uv - 0.5;
+    return dot(radial, radial) > 1e-8 ? normalize(radial) : vec2(1.0, 0.0);
+}
+
+vec2 normalFromGradient(vec2 gradient, vec2 uv) {
+    return dot(gradient, gradient) > 1e-12 ? normalize(gradient) : fallbackNormal(uv);
+}
+
+// 与 sdf_generator.frag 的 encodeNormal 相反
+vec2 decodeNormal(float t) {
+    float x = t < 0.5 ? 1.0 - 4.0 * t : 4.0 * t - 3.0;
+    float y = 1.0 - abs(x);
+    return normalize(vec2(x, t < 0.5 ? y : -y));
+}
+
+// 一侧已饱和（形状外缘）时改用另一侧的单边差分
+float centralDifference(float center, float low, float high) {
+    if (high >= 1.0) return 2.0 * (center - low);
+    if (low >= 1.0) return 2.0 * (high - center);
+    return high - low;
+}
+
+// 按 SDF_FORMAT_* 特化，返回 (距离, 法线.x, 法线.y, 1)
+// 法线需要导数时必须在 discard 之前、所有片元都执行到的位置调用
+vec4 decodeSDFData(vec2 uv) {
+#if defined(SDF_FORMAT_R16F)
+    float distance = texture(sdfTexture, uv).r + 1.0;
+    vec2 normal = normalFromGradient(vec2(dFdx(distance), dFdy(distance)), uv);
+#elif defined(SDF_FORMAT_RG8)
+    float distance = texture(sdfTexture, uv).r;
+    // 法线参数在 0/1 处首尾相接，双线性插值会跨过接缝，取最近纹素
+    ivec2 size = textureSize(sdfTexture, 0);
+    ivec2 texel = clamp(ivec2(uv * vec2(size)), ivec2(0), size - 1);
+    vec2 normal = decodeNormal(texelFetch(sdfTexture, texel, 0).g);
+#elif defined(SDF_FORMAT_R8)
+    // 8 位距离在相邻像素间常常相同，屏幕空间导数会出现成片的零，改用中心差分；
+    // 间距至少 1/128 纹理坐标，高分辨率下差值才能跨过几个量化级
+    float distance = texture(sdfTexture, uv).r;
+    float spacing = max(1.0 / float(textureSize(sdfTexture, 0).x), 1.0 / 128.0);
+    float dx = centralDifference(distance, texture(sdfTexture, uv - vec2(spacing, 0.0)).r,
+                                 texture(sdfTexture, uv + vec2(spacing, 0.0)).r);
+    float dy = centralDifference(distance, texture(sdfTexture, uv - vec2(0.0, spacing)).r,
+                                 texture(sdfTexture, uv + vec2(0.0, spacing)).r);
+    vec2 normal = normalFromGradient(vec2(dx, dy), uv);
+#else
+    vec4 sdfData = texture(sdfTexture, uv);
     float distance = sdfData.r;
     // 修正法线解码：确保方向正确
     vec2 normal = (sdfData.gb - 0.5) * 2.0;
-    return vec4(distance, normal, sdfData.a);
+#endif
+    return vec4(distance, normal, 1.0);
 }
 
 float smoothstep(float edge0, float edge1, float x) {
@@ -46,16 +114,14 @@ void main() {
     vec2 screenCoord = gl_FragCoord.xy;
     
     // 确保SDF纹理采样使用正确的纹理坐标
-    vec4 sdfData = texture(sdfTexture, TexCoord);
-    vec4 decoded = decodeSDFData(sdfData);
+    vec4 decoded = decodeSDFData(TexCoord);
     
     float distance = decoded.r;
     vec2 normal = decoded.gb;
     
-    // 修复：只有当距离小于阈值时才应用效果
+    // 形状之外（包围四边形的角落）直接丢弃，不进入折射计算
     if (distance >= 0.99999) {
-        FragColor = texture(backgroundTexture, TexCoord);
-        return;
+        discard;
     }
     
     float dis = (1.0 - distance) * 50.0 * scale;
@@ -67,7 +133,7 @@ void main() {
         float offset = dis - offsetVal;
         
         vec2 offset_normal = normal * offset;
-        vec4 result = getColorWithOffset(screenCoord, offset_normal);
+        vec4 result = applyDispersion(getColorWithOffset(screenCoord, offset_normal), screenCoord, offset_normal);
         
         if (dis <= ref_border_width) {
             float edgeRatio = 1.0 - (dis / ref_border_width);
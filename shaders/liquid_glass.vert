@@ -1,7 +1,6 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
+// 单位网格平面内的位置，纹理坐标由位置推导
+layout (location = 0) in vec2 aPos;
 
 out vec2 TexCoord;
 out vec3 WorldPos;
@@ -12,9 +11,9 @@ uniform mat4 projection;
 
 void main()
 {
-    vec4 worldPos = model * vec4(aPos, 1.0);
+    vec4 worldPos = model * vec4(aPos, 0.0, 1.0);
     gl_Position = projection * view * worldPos;
     
-    TexCoord = aTexCoord;
+    TexCoord = aPos + 0.5;
     WorldPos = worldPos.xyz;
 }
\ No newline at end of file
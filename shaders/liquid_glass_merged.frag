@@ -0,0 +1,127 @@
+#version 330 core
+out vec4 FragColor;
+
+#define MAX_ELEMENTS 256
+
+// 所有元素合成一个距离场：多项式 smooth-min 让相互靠近的玻璃融合在一起
+uniform sampler2D captureTexture;
+uniform vec2 screenSize;
+uniform usamplerBuffer tileRanges;
+uniform usamplerBuffer tileInstances;
+// 每个元素三个 vec4：(中心, 半尺寸)、(圆角半径, ref_height, ref_length, 图集层号 + 1)、图集 UV 矩形，单位为像素；
+// 圆形为半尺寸相等且圆角取满
+layout(std140) uniform GlassElements {
+    vec4 elements[MAX_ELEMENTS * 3];
+};
+// 图集形状的距离场，R8 编码，0.5 为边缘，atlasSpread 个纹素处饱和
+uniform sampler2DArray sdfAtlas;
+uniform float atlasSpread;
+uniform int tileSize;
+uniform int tilesX;
+uniform float mergeRadius;
+
+uniform float ref_border_width = 5.0;
+uniform float ref_exposure = 1.0;
+
+// 圆角矩形的距离与梯度
+vec3 roundedBoxSDG(vec2 p, vec2 halfSize, float radius) {
+    vec2 w = abs(p) - (halfSize - radius);
+    vec2 s = vec2(p.x < 0.0 ? -1.0 : 1.0, p.y < 0.0 ? -1.0 : 1.0);
+    float g = max(w.x, w.y);
+    vec2 q = max(w, 0.0);
+    float l = length(q);
+    if (g > 0.0) {
+        return vec3(l - radius, s * q / max(l, 1e-6));
+    }
+    return vec3(g - radius, s * (w.x > w.y ? vec2(1.0, 0.0) : vec2(0.0, 1.0)));
+}
+
+// 图集形状的距离（像素）：包围盒内按 UV 矩形采样，盒外沿包围盒距离外推
+float atlasSDF(vec2 p, vec2 halfSize, vec4 uvRect, float layer) {
+    vec2 local = clamp(p / halfSize * 0.5 + 0.5, 0.0, 1.0);
+    float value = texture(sdfAtlas, vec3(mix(uvRect.xy, uvRect.zw, local), layer)).r;
+    vec2 texels = (uvRect.zw - uvRect.xy) * vec2(textureSize(sdfAtlas, 0).xy) + 1.0;
+    vec2 pixelsPerTexel = 2.0 * halfSize / texels;
+    float d = (value - 0.5) * 2.0 * atlasSpread * min(pixelsPerTexel.x, pixelsPerTexel.y);
+    vec2 q = abs(p) - halfSize;
+    return d + length(max(q, 0.0));
+}
+
+// 图集形状的梯度用中心差分
+vec3 atlasSDG(vec2 p, vec2 halfSize, vec4 uvRect, float layer) {
+    float e = 0.5;
+    float d = atlasSDF(p, halfSize, uvRect, layer);
+    vec2 gradient = vec2(atlasSDF(p + vec2(e, 0.0), halfSize, uvRect, layer) -
+                         atlasSDF(p - vec2(e, 0.0), halfSize, uvRect, layer),
+                         atlasSDF(p + vec2(0.0, e), halfSize, uvRect, layer) -
+                         atlasSDF(p - vec2(0.0, e), halfSize, uvRect, layer));
+    return vec3(d, length(gradient) > 1e-4 ? normalize(gradient) : vec2(0.0));
+}
+
+vec4 getColorWithOffset(vec2 coord, vec2 offset) {
+    // 捕获纹理可能大于屏幕，超出屏幕的部分没有内容，截断到屏幕内的纹素中心
+    vec2 pixel = clamp(coord + offset, vec2(0.5), screenSize - 0.5);
+    vec2 normalizedCoord = pixel / vec2(textureSize(captureTexture, 0));
+    vec4 color = texture(captureTexture, normalizedCoord);
+    return vec4(color.rgb * ref_exposure, color.a);
+}
+
+float linear_map(float x, float y, float a, float b, float tsetnumber) {
+    float ratio = (tsetnumber - x) / (y - x);
+    return a + ratio * (b - a);
+}
+
+void main() {
+    vec2 screenCoord = gl_FragCoord.xy;
+    ivec2 tile = ivec2(screenCoord) / tileSize;
+    uvec2 range = texelFetch(tileRanges, tile.y * tilesX + tile.x).rg;
+
+    // 距离、梯度与折射参数一起按 smooth-min 的权重混合
+    float k = max(mergeRadius, 1e-4);
+    float distance = 1e10;
+    vec2 gradient = vec2(0.0);
+    vec2 refraction = vec2(0.0);
+    for (uint i = 0u; i < range.y; i++) {
+        int index = int(texelFetch(tileInstances, int(range.x + i)).r);
+        vec4 shape = elements[index * 3];
+        vec2 p = screenCoord - shape.xy;
+
+        // 形状（包括图集形状）包含在包围盒内，包围盒的有符号距离是真实距离的下界；
+        // 下界比当前场值大出 k 以上时 smooth-min 结果不变，跳过精确计算
+        vec2 q = abs(p) - shape.zw;
+        if (length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) >= distance + k) {
+            continue;
+        }
+
+        vec4 params = elements[index * 3 + 1];
+        vec3 sdg = params.w > 0.0 ? atlasSDG(p, shape.zw, elements[index * 3 + 2], params.w - 1.0)
+                                  : roundedBoxSDG(p, shape.zw, params.x);
+        float h = clamp(0.5 + 0.5 * (distance - sdg.x) / k, 0.0, 1.0);
+        distance = mix(distance, sdg.x, h) - k * h * (1.0 - h);
+        gradient = mix(gradient, sdg.yz, h);
+        refraction = mix(refraction, params.yz, h);
+    }
+    if (distance >= 0.0) {
+        discard;
+    }
+
+    vec2 normal = length(gradient) > 1e-4 ? normalize(gradient) : vec2(0.0);
+    float dis = -distance;
+    float r_height = refraction.x;
+    float r_length = refraction.y;
+    if (dis < r_height) {
+        float offsetVal = linear_map(r_height, 0.0, r_height, r_height - r_length, dis);
+        vec4 result = getColorWithOffset(screenCoord, normal * (dis - offsetVal));
+
+        if (dis <= ref_border_width) {
+            float edgeRatio = 1.0 - (dis / ref_border_width);
+            float smoothRatio = smoothstep(0.0, 1.0, edgeRatio);
+            float angleFactor = abs(normal.x * normal.y);
+            float highlight = smoothRatio * (0.3 + angleFactor * 0.7);
+            result = result * (1.0 + highlight * 0.6);
+        }
+        FragColor = result;
+    } else {
+        FragColor = getColorWithOffset(screenCoord, vec2(0.0));
+    }
+}
@@ -0,0 +1,114 @@
+#version 330 core
+out vec4 FragColor;
+
+// 屏幕尺寸的背景捕获，只有被玻璃（含折射余量）覆盖的 tile 有效
+uniform sampler2D captureTexture;
+uniform vec2 screenSize;
+// 每个 tile 两个值：实例列表中的偏移与数量
+uniform usamplerBuffer tileRanges;
+uniform usamplerBuffer tileInstances;
+// 每个实例三个 texel：(中心, 半尺寸)、(圆角半径, ref_height, ref_length, 图集层号 + 1)、图集 UV 矩形，单位为像素
+uniform samplerBuffer instanceData;
+// 图集形状的距离场，R8 编码，0.5 为边缘，atlasSpread 个纹素处饱和
+uniform sampler2DArray sdfAtlas;
+uniform float atlasSpread;
+uniform int tileSize;
+uniform int tilesX;
+
+uniform float ref_border_width = 5.0;
+uniform float ref_exposure = 1.0;
+
+float roundedBoxSDF(vec2 p, vec2 halfSize, float radius) {
+    vec2 q = abs(p) - halfSize + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+// 图集形状的距离（像素）：包围盒内按 UV 矩形采样，盒外沿包围盒距离外推
+float atlasSDF(vec2 p, vec2 halfSize, vec4 uvRect, float layer) {
+    vec2 local = clamp(p / halfSize * 0.5 + 0.5, 0.0, 1.0);
+    float value = texture(sdfAtlas, vec3(mix(uvRect.xy, uvRect.zw, local), layer)).r;
+    vec2 texels = (uvRect.zw - uvRect.xy) * vec2(textureSize(sdfAtlas, 0).xy) + 1.0;
+    vec2 pixelsPerTexel = 2.0 * halfSize / texels;
+    float d = (value - 0.5) * 2.0 * atlasSpread * min(pixelsPerTexel.x, pixelsPerTexel.y);
+    vec2 q = abs(p) - halfSize;
+    return d + length(max(q, 0.0));
+}
+
+// layer 为 0 时是圆角矩形，否则从图集采样
+float shapeSDF(vec2 p, vec4 shape, vec4 params, vec4 uvRect) {
+    if (params.w > 0.0) {
+        return atlasSDF(p, shape.zw, uvRect, params.w - 1.0);
+    }
+    return roundedBoxSDF(p, shape.zw, params.x);
+}
+
+vec4 getColorWithOffset(vec2 coord, vec2 offset) {
+    // 捕获纹理可能大于屏幕，超出屏幕的部分没有内容，截断到屏幕内的纹素中心
+    vec2 pixel = clamp(coord + offset, vec2(0.5), screenSize - 0.5);
+    vec2 normalizedCoord = pixel / vec2(textureSize(captureTexture, 0));
+    vec4 color = texture(captureTexture, normalizedCoord);
+    return vec4(color.rgb * ref_exposure, color.a);
+}
+
+float linear_map(float x, float y, float a, float b, float tsetnumber) {
+    float ratio = (tsetnumber - x) / (y - x);
+    return a + ratio * (b - a);
+}
+
+void main() {
+    vec2 screenCoord = gl_FragCoord.xy;
+    ivec2 tile = ivec2(screenCoord) / tileSize;
+    uvec2 range = texelFetch(tileRanges, tile.y * tilesX + tile.x).rg;
+
+    // 只遍历本 tile 的实例，后面的实例在上层
+    int hit = -1;
+    float distance = 0.0;
+    vec4 shape = vec4(0.0);
+    vec4 params = vec4(0.0);
+    vec4 uvRect = vec4(0.0);
+    for (uint i = 0u; i < range.y; i++) {
+        int index = int(texelFetch(tileInstances, int(range.x + i)).r);
+        vec4 s = texelFetch(instanceData, index * 3);
+        vec4 p = texelFetch(instanceData, index * 3 + 1);
+        vec4 uv = texelFetch(instanceData, index * 3 + 2);
+        float d = shapeSDF(screenCoord - s.xy, s, p, uv);
+        if (d < 0.0) {
+            hit = index;
+            distance = d;
+            shape = s;
+            params = p;
+            uvRect = uv;
+        }
+    }
+    if (hit < 0) {
+        discard;
+    }
+
+    vec2 local = screenCoord - shape.xy;
+    float e = 0.5;
+    vec2 gradient = vec2(shapeSDF(local + vec2(e, 0.0), shape, params, uvRect) -
+                         shapeSDF(local - vec2(e, 0.0), shape, params, uvRect),
+                         shapeSDF(local + vec2(0.0, e), shape, params, uvRect) -
+                         shapeSDF(local - vec2(0.0, e), shape, params, uvRect));
+    vec2 normal = length(gradient) > 1e-4 ? normalize(gradient) : vec2(0.0);
+
+    // 与 liquid_glass.frag 相同的折射映射，距离直接以像素计
+    float dis = -distance;
+    float r_height = params.y;
+    float r_length = params.z;
+    if (dis < r_height) {
+        float offsetVal = linear_map(r_height, 0.0, r_height, r_height - r_length, dis);
+        vec4 result = getColorWithOffset(screenCoord, normal * (dis - offsetVal));
+
+        if (dis <= ref_border_width) {
+            float edgeRatio = 1.0 - (dis / ref_border_width);
+            float smoothRatio = smoothstep(0.0, 1.0, edgeRatio);
+            float angleFactor = abs(normal.x * normal.y);
+            float highlight = smoothRatio * (0.3 + angleFactor * 0.7);
+            result = result * (1.0 + highlight * 0.6);
+        }
+        FragColor = result;
+    } else {
+        FragColor = getColorWithOffset(screenCoord, vec2(0.0));
+    }
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+// 不需要顶点属性：按 gl_VertexID 生成覆盖 rect 的三角形带
+uniform vec4 rect;        // 像素矩形 (x, y, width, height)，原点在左下角
+uniform vec2 screenSize;
+
+void main()
+{
+    vec2 corner = vec2(float(gl_VertexID & 1), float((gl_VertexID >> 1) & 1));
+    vec2 pixel = rect.xy + corner * rect.zw;
+    gl_Position = vec4(pixel / screenSize * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -5,6 +5,15 @@ out vec4 FragColor;
 
 uniform vec2 resolution;
 
+// 存储格式由 SDFGenerator 以 SDF_FORMAT_* 定义注入，与 liquid_glass.frag 的 decodeSDFData 对应
+
+// 单位法线按菱形（L1 单位圆，二维的八面体映射）展开为 [0,1] 参数：
+// 上半圈 x 从 1 到 -1 对应 [0,0.5]，下半圈 x 从 -1 到 1 对应 [0.5,1]
+float encodeNormal(vec2 n) {
+    vec2 p = n / (abs(n.x) + abs(n.y));
+    return n.y >= 0.0 ? (1.0 - p.x) * 0.25 : 0.5 + (1.0 + p.x) * 0.25;
+}
+
 float circleSDF(vec2 p, float radius) {
     return length(p) - radius;
 }
@@ -32,12 +41,25 @@ vec4 generateCircleSDF() {
     
     // 标准化距离值到[0,1]范围
     float normalizedDist = distance / radius;
+#if defined(SDF_FORMAT_R16F)
+    // 浮点格式不在边缘处截断，边缘像素的屏幕空间导数才不会被饱和值拉偏；
+    // 存 distanceValue - 1，半精度的有效位集中在折射发生的边缘附近
+    normalizedDist = max(normalizedDist, -1.0);
+    return vec4((normalizedDist + 1.0) * 0.5 - 1.0, 0.0, 0.0, 1.0);
+#endif
     normalizedDist = clamp(normalizedDist, -1.0, 1.0);
     
     float distanceValue = (normalizedDist + 1.0) * 0.5;
     vec2 directionValue = normalDir * 0.5 + 0.5;
     
+#if defined(SDF_FORMAT_RG8)
+    return vec4(distanceValue, encodeNormal(normalDir), 0.0, 1.0);
+#elif defined(SDF_FORMAT_R8)
+    // 只存距离，法线在采样端重建
+    return vec4(distanceValue, 0.0, 0.0, 1.0);
+#else
     return vec4(distanceValue, directionValue.x, directionValue.y, 1.0);
+#endif
 }
 
 void main() {
@@ -0,0 +1,76 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef LIQUIDGLASS_COUNT_ALLOCATIONS
+
+namespace {
+
+thread_local uint64_t t_allocations = 0;
+
+void* CountedAlloc(size_t size)
+{
+    t_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* CountedAlignedAlloc(size_t size, size_t alignment)
+{
+    t_allocations++;
+#ifdef _WIN32
+    void* p = _aligned_malloc(size ? size : 1, alignment);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment < sizeof(void*) ? sizeof(void*) : alignment, size ? size : 1) != 0) p = nullptr;
+#endif
+    if (p) return p;
+    throw std::bad_alloc();
+}
+
+void AlignedFree(void* p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+}
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+void* operator new(size_t size, std::align_val_t alignment) { return CountedAlignedAlloc(size, size_t(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return CountedAlignedAlloc(size, size_t(alignment)); }
+void operator delete(void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { AlignedFree(p); }
+
+bool AllocationCounter::IsEnabled() { return true; }
+uint64_t AllocationCounter::GetThreadAllocations() { return t_allocations; }
+
+#else
+
+bool AllocationCounter::IsEnabled() { return false; }
+uint64_t AllocationCounter::GetThreadAllocations() { return 0; }
+
+#endif
+
+void AllocationScope::ExpectNone(const char* what) const
+{
+    uint64_t count = GetCount();
+    if (count == 0) return;
+    std::cerr << "AllocationScope: " << count << " heap allocation(s) in " << what << std::endl;
+    std::abort();
+}
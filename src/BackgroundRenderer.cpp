@@ -1,11 +1,25 @@
 ﻿#include "BackgroundRenderer.h"
 #include "TextureLoader.h"
+#include "TextureUploader.h"
+#include "TextureContainer.h"
 #include "Shader.h"
+#include <stb_image.h>
 #include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <chrono>
 
-BackgroundRenderer::BackgroundRenderer() : m_VAO(0), m_VBO(0), m_EBO(0), 
-    m_shaderProgram(0), m_texture(0), m_screenWidth(800), m_screenHeight(600), 
-    m_initialized(false) {
+namespace {
+
+bool EndsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}
+
+BackgroundRenderer::BackgroundRenderer() : m_VBO(0), m_EBO(0), 
+    m_shaderProgram(0), m_texture(0),
+    m_initialized(false), m_compressTextures(false), m_generation(0), m_contentVersion(0), m_uploader(nullptr) {
 }
 
 BackgroundRenderer::~BackgroundRenderer() {
@@ -35,25 +49,25 @@ void BackgroundRenderer::CreateFullscreenQuad() {
         2, 3, 0
     };
     
-    glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
     glGenBuffers(1, &m_EBO);
     
-    glBindVertexArray(m_VAO);
-    
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
+    GLuint vbo = m_VBO, ebo = m_EBO;
+    m_VAO.Initialize([vbo, ebo]() {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+    });
 }
 
 void BackgroundRenderer::LoadShader() {
@@ -100,12 +114,134 @@ void BackgroundRenderer::LoadShader() {
 }
 
 void BackgroundRenderer::LoadBackground(const std::string& imagePath) {
-    m_texture = TextureLoader::loadTexture(imagePath);
+    // 优先使用同名的预解码容器（background.png -> background.lgtex），省去 PNG 解码
+    std::string containerPath = imagePath;
+    if (!EndsWith(imagePath, ".lgtex")) {
+        size_t dot = imagePath.find_last_of('.');
+        containerPath = (dot == std::string::npos ? imagePath : imagePath.substr(0, dot)) + ".lgtex";
+    }
+
+    std::ifstream containerFile(containerPath, std::ios::binary);
+    bool hasContainer = containerFile.good();
+    containerFile.close();
+    m_generation++;
+
+    if (m_uploader && m_uploader->IsRunning() && m_texture != 0) {
+        int ticket = m_uploader->Submit([hasContainer, containerPath, imagePath]() {
+            GLuint texture = hasContainer ? TextureLoader::loadTextureContainer(containerPath) : 0;
+            if (texture == 0 && containerPath != imagePath) {
+                texture = TextureLoader::loadTexture(imagePath);
+            }
+            return texture;
+        });
+        m_pendingUploads.push_back({ ticket, m_generation, imagePath, false });
+        if (!hasContainer && containerPath != imagePath && m_compressTextures && TextureLoader::isBC1Supported()) {
+            StartCompression(imagePath, containerPath);
+        }
+        return;
+    }
+
+    if (m_texture != 0) {
+        TextureLoader::deleteTexture(m_texture);
+        m_texture = 0;
+    }
+    if (hasContainer) {
+        m_texture = TextureLoader::loadTextureContainer(containerPath);
+    }
+    m_contentVersion++;
+    if (m_texture == 0 && containerPath != imagePath) {
+        m_texture = TextureLoader::loadTexture(imagePath);
+        if (m_compressTextures && TextureLoader::isBC1Supported()) {
+            StartCompression(imagePath, containerPath);
+        }
+    }
     if (m_texture == 0) {
         std::cerr << "Failed to load background image: " << imagePath << std::endl;
     }
 }
 
+void BackgroundRenderer::StartCompression(const std::string& imagePath, const std::string& containerPath) {
+    PendingCompression pending;
+    pending.generation = m_generation;
+    pending.containerPath = containerPath;
+    pending.result = std::async(std::launch::async, [imagePath, containerPath]() {
+        int width, height, channels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+        if (!data) return false;
+
+        // 先写临时文件再改名，避免渲染线程映射到写了一半的容器
+        std::string tempPath = containerPath + ".tmp";
+        bool ok = TextureContainer::Write(tempPath, width, height, TextureContainerFormat::BC1, data);
+        stbi_image_free(data);
+        if (ok) {
+            std::remove(containerPath.c_str());
+            ok = std::rename(tempPath.c_str(), containerPath.c_str()) == 0;
+        }
+        return ok;
+    });
+    m_pendingCompressions.push_back(std::move(pending));
+}
+
+bool BackgroundRenderer::Update() {
+    bool replaced = false;
+    for (size_t i = 0; i < m_pendingUploads.size(); ) {
+        PendingUpload& pending = m_pendingUploads[i];
+        GLuint texture = 0;
+        if (!m_uploader->TryTake(pending.ticket, texture)) {
+            i++;
+            continue;
+        }
+
+        // 上传期间又切换了背景，结果直接丢弃
+        if (pending.generation != m_generation) {
+            if (texture != 0) {
+                TextureLoader::deleteTexture(texture);
+            }
+        } else if (texture == 0) {
+            std::cerr << "Failed to load background image: " << pending.path << std::endl;
+        } else {
+            TextureLoader::deleteTexture(m_texture);
+            m_texture = texture;
+            m_contentVersion++;
+            replaced = true;
+            if (pending.compressed) {
+                std::cout << "Background compressed to BC1: " << pending.path << std::endl;
+            }
+        }
+        m_pendingUploads.erase(m_pendingUploads.begin() + i);
+    }
+
+    for (size_t i = 0; i < m_pendingCompressions.size(); ) {
+        PendingCompression& pending = m_pendingCompressions[i];
+        if (pending.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            i++;
+            continue;
+        }
+
+        // 期间已经切换到其他背景的结果只保留在磁盘上，下次加载时直接使用
+        if (pending.result.get() && pending.generation == m_generation) {
+            if (m_uploader && m_uploader->IsRunning()) {
+                std::string containerPath = pending.containerPath;
+                int ticket = m_uploader->Submit([containerPath]() {
+                    return TextureLoader::loadTextureContainer(containerPath);
+                });
+                m_pendingUploads.push_back({ ticket, m_generation, containerPath, true });
+            } else {
+                GLuint compressed = TextureLoader::loadTextureContainer(pending.containerPath);
+                if (compressed != 0) {
+                    TextureLoader::deleteTexture(m_texture);
+                    m_texture = compressed;
+                    m_contentVersion++;
+                    replaced = true;
+                    std::cout << "Background compressed to BC1: " << pending.containerPath << std::endl;
+                }
+            }
+        }
+        m_pendingCompressions.erase(m_pendingCompressions.begin() + i);
+    }
+    return replaced;
+}
+
 void BackgroundRenderer::Render(const glm::mat4& projection, const glm::mat4& view) {
     if (!m_initialized || m_texture == 0) return;
     
@@ -118,7 +254,7 @@ void BackgroundRenderer::Render(const glm::mat4& projection, const glm::mat4& vi
     glBindTexture(GL_TEXTURE_2D, m_texture);
     glUniform1i(glGetUniformLocation(m_shaderProgram, "backgroundTexture"), 0);
     
-    glBindVertexArray(m_VAO);
+    m_VAO.Bind();
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
     
@@ -126,21 +262,25 @@ void BackgroundRenderer::Render(const glm::mat4& projection, const glm::mat4& vi
     glEnable(GL_DEPTH_TEST);
 }
 
-void BackgroundRenderer::SetScreenSize(int width, int height) {
-    m_screenWidth = width;
-    m_screenHeight = height;
+void BackgroundRenderer::AddPass(RenderGraph& graph, RenderResource target, const glm::mat4& projection, const glm::mat4& view) {
+    BackgroundRenderer* renderer = this;
+    graph.AddPass("Background", [=](const RenderPassContext& context) {
+        context.BindTarget();
+        renderer->Render(projection, view);
+    }).Write(target);
 }
 
 void BackgroundRenderer::Cleanup() {
+    m_pendingCompressions.clear();
+    // 未取走的纹理由上传线程停止时删除
+    m_pendingUploads.clear();
+
     if (m_texture != 0) {
         TextureLoader::deleteTexture(m_texture);
         m_texture = 0;
     }
     
-    if (m_VAO != 0) {
-        glDeleteVertexArrays(1, &m_VAO);
-        m_VAO = 0;
-    }
+    m_VAO.Cleanup();
     
     if (m_VBO != 0) {
         glDeleteBuffers(1, &m_VBO);
@@ -0,0 +1,368 @@
+#include "BlockCompressor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BLOCK_COMPRESSOR_SSE2 1
+#endif
+
+namespace {
+
+struct Block {
+    int16_t r[16];
+    int16_t g[16];
+    int16_t b[16];
+};
+
+uint16_t Pack565(float r, float g, float b)
+{
+    int ri = std::min(31, std::max(0, int(r * (31.0f / 255.0f) + 0.5f)));
+    int gi = std::min(63, std::max(0, int(g * (63.0f / 255.0f) + 0.5f)));
+    int bi = std::min(31, std::max(0, int(b * (31.0f / 255.0f) + 0.5f)));
+    return static_cast<uint16_t>((ri << 11) | (gi << 5) | bi);
+}
+
+void Unpack565(uint16_t c, int rgb[3])
+{
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// 4 色模式调色板：c0, c1, (2c0+c1)/3, (c0+2c1)/3
+void BuildPalette(uint16_t c0, uint16_t c1, int palette[4][3])
+{
+    Unpack565(c0, palette[0]);
+    Unpack565(c1, palette[1]);
+    for (int i = 0; i < 3; i++) {
+        palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+        palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+    }
+}
+
+// 为 16 个像素选择最近的调色板索引，返回总平方误差
+int FindIndices(const Block& block, const int palette[4][3], uint8_t indices[16])
+{
+#ifdef BLOCK_COMPRESSOR_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    int total = 0;
+    for (int half = 0; half < 2; half++) {
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.r + half * 8));
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.g + half * 8));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.b + half * 8));
+
+        __m128i bestLo = _mm_set1_epi32(0x7fffffff), bestHi = bestLo;
+        __m128i indexLo = zero, indexHi = zero;
+        for (int k = 0; k < 4; k++) {
+            __m128i dr = _mm_sub_epi16(r, _mm_set1_epi16(int16_t(palette[k][0])));
+            __m128i dg = _mm_sub_epi16(g, _mm_set1_epi16(int16_t(palette[k][1])));
+            __m128i db = _mm_sub_epi16(b, _mm_set1_epi16(int16_t(palette[k][2])));
+
+            // madd 把相邻的 16 位平方相加为 32 位：dr^2 + dg^2，db^2 + 0
+            __m128i rgLo = _mm_unpacklo_epi16(dr, dg), rgHi = _mm_unpackhi_epi16(dr, dg);
+            __m128i bLo = _mm_unpacklo_epi16(db, zero), bHi = _mm_unpackhi_epi16(db, zero);
+            __m128i distLo = _mm_add_epi32(_mm_madd_epi16(rgLo, rgLo), _mm_madd_epi16(bLo, bLo));
+            __m128i distHi = _mm_add_epi32(_mm_madd_epi16(rgHi, rgHi), _mm_madd_epi16(bHi, bHi));
+
+            __m128i k4 = _mm_set1_epi32(k);
+            __m128i maskLo = _mm_cmplt_epi32(distLo, bestLo);
+            __m128i maskHi = _mm_cmplt_epi32(distHi, bestHi);
+            bestLo = _mm_or_si128(_mm_and_si128(maskLo, distLo), _mm_andnot_si128(maskLo, bestLo));
+            bestHi = _mm_or_si128(_mm_and_si128(maskHi, distHi), _mm_andnot_si128(maskHi, bestHi));
+            indexLo = _mm_or_si128(_mm_and_si128(maskLo, k4), _mm_andnot_si128(maskLo, indexLo));
+            indexHi = _mm_or_si128(_mm_and_si128(maskHi, k4), _mm_andnot_si128(maskHi, indexHi));
+        }
+
+        alignas(16) int32_t best[8];
+        alignas(16) int32_t index[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(best), bestLo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(best + 4), bestHi);
+        _mm_store_si128(reinterpret_cast<__m128i*>(index), indexLo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(index + 4), indexHi);
+        for (int i = 0; i < 8; i++) {
+            indices[half * 8 + i] = uint8_t(index[i]);
+            total += best[i];
+        }
+    }
+    return total;
+#else
+    int total = 0;
+    for (int i = 0; i < 16; i++) {
+        int bestDist = 0x7fffffff;
+        for (int k = 0; k < 4; k++) {
+            int dr = block.r[i] - palette[k][0];
+            int dg = block.g[i] - palette[k][1];
+            int db = block.b[i] - palette[k][2];
+            int dist = dr * dr + dg * dg + db * db;
+            if (dist < bestDist) {
+                bestDist = dist;
+                indices[i] = uint8_t(k);
+            }
+        }
+        total += bestDist;
+    }
+    return total;
+#endif
+}
+
+// 主成分方向上的投影极值作为初始端点
+void PrincipalEndpoints(const Block& block, float c0[3], float c1[3])
+{
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    float minColor[3] = { 255.0f, 255.0f, 255.0f };
+    float maxColor[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++) {
+        float p[3] = { float(block.r[i]), float(block.g[i]), float(block.b[i]) };
+        for (int c = 0; c < 3; c++) {
+            mean[c] += p[c];
+            minColor[c] = std::min(minColor[c], p[c]);
+            maxColor[c] = std::max(maxColor[c], p[c]);
+        }
+    }
+    for (int c = 0; c < 3; c++) mean[c] /= 16.0f;
+
+    float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++) {
+        float d[3] = { block.r[i] - mean[0], block.g[i] - mean[1], block.b[i] - mean[2] };
+        cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+    }
+
+    float axis[3] = { maxColor[0] - minColor[0], maxColor[1] - minColor[1], maxColor[2] - minColor[2] };
+    for (int iteration = 0; iteration < 4; iteration++) {
+        float next[3] = {
+            cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+            cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+            cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]
+        };
+        float length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+        if (length < 1e-6f) break;
+        for (int c = 0; c < 3; c++) axis[c] = next[c] / length;
+    }
+
+    float lengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    if (lengthSq < 1e-6f) {
+        for (int c = 0; c < 3; c++) c0[c] = c1[c] = mean[c];
+        return;
+    }
+
+    float tMin = 1e30f, tMax = -1e30f;
+    for (int i = 0; i < 16; i++) {
+        float t = ((block.r[i] - mean[0]) * axis[0] + (block.g[i] - mean[1]) * axis[1] +
+                   (block.b[i] - mean[2]) * axis[2]) / lengthSq;
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+
+    // 端点向内收缩 1/16，减小 565 量化带来的误差
+    float inset = (tMax - tMin) / 16.0f;
+    tMin += inset;
+    tMax -= inset;
+    for (int c = 0; c < 3; c++) {
+        c0[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tMax));
+        c1[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tMin));
+    }
+}
+
+// 固定索引后用最小二乘求解最优端点
+bool RefineEndpoints(const Block& block, const uint8_t indices[16], float c0[3], float c1[3])
+{
+    static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++) {
+        float a = weights[indices[i]];
+        float b = 1.0f - a;
+        float p[3] = { float(block.r[i]), float(block.g[i]), float(block.b[i]) };
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; c++) {
+            ax[c] += a * p[c];
+            bx[c] += b * p[c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) return false;
+
+    float inv = 1.0f / det;
+    for (int c = 0; c < 3; c++) {
+        c0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) * inv));
+        c1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) * inv));
+    }
+    return true;
+}
+
+void WriteBlock(uint16_t c0, uint16_t c1, const uint8_t indices[16], unsigned char* out)
+{
+    uint8_t remapped[16];
+    std::memcpy(remapped, indices, 16);
+
+    // 4 色模式要求 c0 > c1；交换端点时索引 0<->1、2<->3 同时交换
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        for (int i = 0; i < 16; i++) remapped[i] ^= 1;
+    } else if (c0 == c1) {
+        std::memset(remapped, 0, 16);
+    }
+
+    uint32_t bits = 0;
+    for (int i = 15; i >= 0; i--) {
+        bits = (bits << 2) | remapped[i];
+    }
+    out[0] = uint8_t(c0);
+    out[1] = uint8_t(c0 >> 8);
+    out[2] = uint8_t(c1);
+    out[3] = uint8_t(c1 >> 8);
+    out[4] = uint8_t(bits);
+    out[5] = uint8_t(bits >> 8);
+    out[6] = uint8_t(bits >> 16);
+    out[7] = uint8_t(bits >> 24);
+}
+
+void CompressBlockRows(const unsigned char* rgba, uint32_t width, uint32_t height,
+                       unsigned char* out, uint32_t blockRowBegin, uint32_t blockRowEnd)
+{
+    const uint32_t blocksX = (width + 3) / 4;
+    unsigned char block[64];
+    for (uint32_t by = blockRowBegin; by < blockRowEnd; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            // 边缘不足 4 像素的块重复最后一行/列
+            for (uint32_t y = 0; y < 4; y++) {
+                uint32_t sy = std::min(by * 4 + y, height - 1);
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t sx = std::min(bx * 4 + x, width - 1);
+                    std::memcpy(block + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+                }
+            }
+            BlockCompressor::CompressBC1Block(block, out + (size_t(by) * blocksX + bx) * 8);
+        }
+    }
+}
+
+}
+
+size_t BlockCompressor::BC1Size(uint32_t width, uint32_t height)
+{
+    return size_t((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+void BlockCompressor::CompressBC1Block(const unsigned char* pixels, unsigned char* out)
+{
+    Block block;
+    bool solid = true;
+    for (int i = 0; i < 16; i++) {
+        block.r[i] = pixels[i * 4 + 0];
+        block.g[i] = pixels[i * 4 + 1];
+        block.b[i] = pixels[i * 4 + 2];
+        solid = solid && block.r[i] == block.r[0] && block.g[i] == block.g[0] && block.b[i] == block.b[0];
+    }
+
+    uint8_t indices[16];
+    if (solid) {
+        std::memset(indices, 0, sizeof(indices));
+        uint16_t c = Pack565(block.r[0], block.g[0], block.b[0]);
+        WriteBlock(c, c, indices, out);
+        return;
+    }
+
+    float c0[3], c1[3];
+    PrincipalEndpoints(block, c0, c1);
+    uint16_t e0 = Pack565(c0[0], c0[1], c0[2]);
+    uint16_t e1 = Pack565(c1[0], c1[1], c1[2]);
+
+    int palette[4][3];
+    BuildPalette(e0, e1, palette);
+    int error = FindIndices(block, palette, indices);
+
+    float r0[3], r1[3];
+    if (RefineEndpoints(block, indices, r0, r1)) {
+        uint16_t f0 = Pack565(r0[0], r0[1], r0[2]);
+        uint16_t f1 = Pack565(r1[0], r1[1], r1[2]);
+        if (f0 != f1 && (f0 != e0 || f1 != e1)) {
+            uint8_t refined[16];
+            BuildPalette(f0, f1, palette);
+            int refinedError = FindIndices(block, palette, refined);
+            if (refinedError < error) {
+                e0 = f0;
+                e1 = f1;
+                std::memcpy(indices, refined, sizeof(indices));
+            }
+        }
+    }
+
+    WriteBlock(e0, e1, indices, out);
+}
+
+void BlockCompressor::CompressBC1(const unsigned char* rgba, uint32_t width, uint32_t height,
+                                  unsigned char* out, int threadCount)
+{
+    const uint32_t blockRows = (height + 3) / 4;
+    if (threadCount <= 0) {
+        threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+    threadCount = std::min<int>(threadCount, int(blockRows));
+
+    if (threadCount <= 1) {
+        CompressBlockRows(rgba, width, height, out, 0, blockRows);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    const uint32_t rowsPerThread = (blockRows + threadCount - 1) / threadCount;
+    for (int t = 0; t < threadCount; t++) {
+        uint32_t begin = t * rowsPerThread;
+        uint32_t end = std::min(blockRows, begin + rowsPerThread);
+        if (begin >= end) break;
+        threads.emplace_back(CompressBlockRows, rgba, width, height, out, begin, end);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void BlockCompressor::DecompressBC1(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgba)
+{
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const unsigned char* block = blocks + (size_t(by) * blocksX + bx) * 8;
+            uint16_t c0 = uint16_t(block[0] | (block[1] << 8));
+            uint16_t c1 = uint16_t(block[2] | (block[3] << 8));
+            uint32_t bits = uint32_t(block[4]) | (uint32_t(block[5]) << 8) |
+                            (uint32_t(block[6]) << 16) | (uint32_t(block[7]) << 24);
+
+            int palette[4][3];
+            int alpha[4] = { 255, 255, 255, 255 };
+            if (c0 > c1) {
+                BuildPalette(c0, c1, palette);
+            } else {
+                Unpack565(c0, palette[0]);
+                Unpack565(c1, palette[1]);
+                for (int i = 0; i < 3; i++) {
+                    palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+                    palette[3][i] = 0;
+                }
+                alpha[3] = 0;
+            }
+
+            for (uint32_t i = 0; i < 16; i++) {
+                uint32_t x = bx * 4 + (i & 3);
+                uint32_t y = by * 4 + (i >> 2);
+                if (x >= width || y >= height) continue;
+                uint32_t index = (bits >> (i * 2)) & 3;
+                unsigned char* p = rgba + (size_t(y) * width + x) * 4;
+                p[0] = static_cast<unsigned char>(palette[index][0]);
+                p[1] = static_cast<unsigned char>(palette[index][1]);
+                p[2] = static_cast<unsigned char>(palette[index][2]);
+                p[3] = static_cast<unsigned char>(alpha[index]);
+            }
+        }
+    }
+}
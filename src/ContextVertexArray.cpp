@@ -0,0 +1,78 @@
+#include "ContextVertexArray.h"
+#include <GLFW/glfw3.h>
+
+namespace {
+
+struct OrphanedVertexArray {
+    GLFWwindow* context;
+    GLuint vao;
+};
+
+// 只在渲染线程上访问
+std::vector<OrphanedVertexArray> orphanedVertexArrays;
+
+}
+
+ContextVertexArray::ContextVertexArray()
+{
+}
+
+ContextVertexArray::~ContextVertexArray()
+{
+    Cleanup();
+}
+
+void ContextVertexArray::Initialize(const Setup& setup)
+{
+    Cleanup();
+    m_setup = setup;
+    Bind();
+    glBindVertexArray(0);
+}
+
+void ContextVertexArray::Bind() const
+{
+    GLFWwindow* context = glfwGetCurrentContext();
+    for (const Entry& entry : m_entries) {
+        if (entry.context == context) {
+            glBindVertexArray(entry.vao);
+            return;
+        }
+    }
+
+    Entry entry = { context, 0 };
+    glGenVertexArrays(1, &entry.vao);
+    glBindVertexArray(entry.vao);
+    if (m_setup) {
+        m_setup();
+    }
+    m_entries.push_back(entry);
+}
+
+void ContextVertexArray::Cleanup()
+{
+    GLFWwindow* context = glfwGetCurrentContext();
+    for (const Entry& entry : m_entries) {
+        if (entry.context == context) {
+            glDeleteVertexArrays(1, &entry.vao);
+        } else {
+            orphanedVertexArrays.push_back({ entry.context, entry.vao });
+        }
+    }
+    m_entries.clear();
+    m_setup = nullptr;
+}
+
+void ContextVertexArray::ReleaseOrphans()
+{
+    GLFWwindow* context = glfwGetCurrentContext();
+    for (size_t i = 0; i < orphanedVertexArrays.size(); ) {
+        if (orphanedVertexArrays[i].context != context) {
+            i++;
+            continue;
+        }
+        glDeleteVertexArrays(1, &orphanedVertexArrays[i].vao);
+        orphanedVertexArrays[i] = orphanedVertexArrays.back();
+        orphanedVertexArrays.pop_back();
+    }
+}
@@ -0,0 +1,176 @@
+#include "DamageTracker.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstring>
+
+// buffer_age 需要原生窗口句柄，只在 CMake 检测到对应平台时编译
+#if defined(LIQUIDGLASS_BUFFER_AGE_GLX)
+#define GLFW_EXPOSE_NATIVE_X11
+#define GLFW_EXPOSE_NATIVE_GLX
+#endif
+#if defined(LIQUIDGLASS_BUFFER_AGE_EGL)
+#define GLFW_EXPOSE_NATIVE_EGL
+#endif
+#if defined(LIQUIDGLASS_BUFFER_AGE_GLX) || defined(LIQUIDGLASS_BUFFER_AGE_EGL)
+#include <GLFW/glfw3native.h>
+#endif
+
+#ifndef GLX_BACK_BUFFER_AGE_EXT
+#define GLX_BACK_BUFFER_AGE_EXT 0x20F4
+#endif
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
+#if defined(LIQUIDGLASS_BUFFER_AGE_GLX) || defined(LIQUIDGLASS_BUFFER_AGE_EGL)
+namespace {
+
+bool HasExtension(const char* extensions, const char* name)
+{
+    if (!extensions) return false;
+    size_t length = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+        bool start = p == extensions || p[-1] == ' ';
+        bool end = p[length] == ' ' || p[length] == '\0';
+        if (start && end) return true;
+    }
+    return false;
+}
+
+}
+#endif
+
+DamageTracker::DamageTracker()
+    : m_width(0), m_height(0), m_current{ 0, 0, 0, 0 }, m_currentFull(true)
+    , m_redrawnPixels(0.0), m_totalPixels(0.0)
+    , m_bufferAgeWindow(nullptr), m_bufferAgeSource(BufferAgeSource::Unknown)
+{
+    Reset(0, 0);
+}
+
+void DamageTracker::Reset(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_current = { 0, 0, 0, 0 };
+    m_currentFull = true;
+    for (int i = 0; i < kMaxBufferAge; i++) {
+        m_history[i] = { 0, 0, 0, 0 };
+        m_historyFull[i] = true;
+    }
+}
+
+ScreenRect DamageTracker::Clip(const ScreenRect& rect) const
+{
+    int x0 = std::max(rect.x, 0);
+    int y0 = std::max(rect.y, 0);
+    int x1 = std::min(rect.x + rect.width, m_width);
+    int y1 = std::min(rect.y + rect.height, m_height);
+    if (x1 <= x0 || y1 <= y0) return { 0, 0, 0, 0 };
+    return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+ScreenRect DamageTracker::Union(const ScreenRect& a, const ScreenRect& b)
+{
+    if (a.IsEmpty()) return b;
+    if (b.IsEmpty()) return a;
+    int x0 = std::min(a.x, b.x);
+    int y0 = std::min(a.y, b.y);
+    int x1 = std::max(a.x + a.width, b.x + b.width);
+    int y1 = std::max(a.y + a.height, b.y + b.height);
+    return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+ScreenRect DamageTracker::Inflate(const ScreenRect& rect, int margin)
+{
+    if (rect.IsEmpty()) return rect;
+    return { rect.x - margin, rect.y - margin, rect.width + 2 * margin, rect.height + 2 * margin };
+}
+
+void DamageTracker::AddDamage(const ScreenRect& rect)
+{
+    m_current = Union(m_current, Clip(rect));
+}
+
+bool DamageTracker::IsFullRedraw(const ScreenRect& rect) const
+{
+    return rect.x <= 0 && rect.y <= 0 && rect.width >= m_width && rect.height >= m_height;
+}
+
+ScreenRect DamageTracker::EndFrame(int bufferAge)
+{
+    // 缓冲里是 age 帧之前的画面，之后每一帧（含本帧）改动过的区域都要重画
+    bool full = m_currentFull || bufferAge <= 0 || bufferAge > kMaxBufferAge;
+    ScreenRect redraw = m_current;
+    for (int i = 0; !full && i < bufferAge - 1; i++) {
+        full = m_historyFull[i];
+        redraw = Union(redraw, m_history[i]);
+    }
+    if (full) {
+        redraw = { 0, 0, m_width, m_height };
+    }
+
+    for (int i = kMaxBufferAge - 1; i > 0; i--) {
+        m_history[i] = m_history[i - 1];
+        m_historyFull[i] = m_historyFull[i - 1];
+    }
+    m_history[0] = m_current;
+    m_historyFull[0] = m_currentFull;
+    m_current = { 0, 0, 0, 0 };
+    m_currentFull = false;
+
+    m_redrawnPixels += double(redraw.width) * redraw.height;
+    m_totalPixels += double(m_width) * m_height;
+    return redraw;
+}
+
+#if defined(LIQUIDGLASS_BUFFER_AGE_GLX) || defined(LIQUIDGLASS_BUFFER_AGE_EGL)
+int DamageTracker::QueryBufferAge(GLFWwindow* window)
+{
+    // 查询方式按窗口确定一次，之后每帧只剩一次 query 调用
+    BufferAgeSource& source = m_bufferAgeSource;
+    if (window != m_bufferAgeWindow) {
+        m_bufferAgeWindow = window;
+        source = BufferAgeSource::None;
+#if defined(LIQUIDGLASS_BUFFER_AGE_EGL)
+        EGLDisplay eglDisplay = glfwGetEGLDisplay();
+        if (source == BufferAgeSource::None && eglDisplay != EGL_NO_DISPLAY &&
+            glfwGetEGLSurface(window) != EGL_NO_SURFACE &&
+            HasExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_EXT_buffer_age")) {
+            source = BufferAgeSource::EGL;
+        }
+#endif
+#if defined(LIQUIDGLASS_BUFFER_AGE_GLX)
+        Display* x11Display = glfwGetX11Display();
+        if (source == BufferAgeSource::None && x11Display && glfwGetGLXWindow(window) &&
+            HasExtension(glXQueryExtensionsString(x11Display, DefaultScreen(x11Display)), "GLX_EXT_buffer_age")) {
+            source = BufferAgeSource::GLX;
+        }
+#endif
+    }
+
+#if defined(LIQUIDGLASS_BUFFER_AGE_EGL)
+    if (source == BufferAgeSource::EGL) {
+        EGLint age = 0;
+        if (eglQuerySurface(glfwGetEGLDisplay(), glfwGetEGLSurface(window), EGL_BUFFER_AGE_EXT, &age)) {
+            return int(age);
+        }
+        return 0;
+    }
+#endif
+#if defined(LIQUIDGLASS_BUFFER_AGE_GLX)
+    if (source == BufferAgeSource::GLX) {
+        unsigned int age = 0;
+        glXQueryDrawable(glfwGetX11Display(), glfwGetGLXWindow(window), GLX_BACK_BUFFER_AGE_EXT, &age);
+        return int(age);
+    }
+#endif
+    return 0;
+}
+#else
+int DamageTracker::QueryBufferAge(GLFWwindow*)
+{
+    // WGL 等平台没有可用的 buffer_age，后台缓冲内容视为未定义，每帧整帧重绘
+    return 0;
+}
+#endif
@@ -0,0 +1,92 @@
+#include "FrameAllocator.h"
+#include <algorithm>
+
+namespace {
+
+uintptr_t AlignUp(uintptr_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~uintptr_t(alignment - 1);
+}
+
+}
+
+LinearArena::LinearArena(size_t capacity)
+    : m_base(nullptr), m_capacity(capacity), m_offset(0)
+    , m_overflowCurrent(nullptr), m_overflowOffset(0), m_overflowCapacity(0)
+    , m_used(0), m_peakUsed(0)
+{
+    m_base = static_cast<unsigned char*>(::operator new(m_capacity));
+    m_overflowBlocks.reserve(8);
+}
+
+LinearArena::~LinearArena()
+{
+    Reset();
+    ::operator delete(m_base);
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_base);
+    uintptr_t aligned = AlignUp(base + m_offset, alignment);
+    if (aligned + size <= base + m_capacity) {
+        m_used += (aligned + size) - (base + m_offset);
+        m_offset = size_t(aligned + size - base);
+        m_peakUsed = std::max(m_peakUsed, m_used);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // 主块用完：在溢出块中继续分配，溢出块不够时再申请一块
+    if (m_overflowCurrent) {
+        uintptr_t overflowBase = reinterpret_cast<uintptr_t>(m_overflowCurrent);
+        aligned = AlignUp(overflowBase + m_overflowOffset, alignment);
+        if (aligned + size <= overflowBase + m_overflowCapacity) {
+            m_used += (aligned + size) - (overflowBase + m_overflowOffset);
+            m_overflowOffset = size_t(aligned + size - overflowBase);
+            m_peakUsed = std::max(m_peakUsed, m_used);
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    m_overflowCapacity = std::max(m_capacity, size + alignment);
+    m_overflowCurrent = static_cast<unsigned char*>(::operator new(m_overflowCapacity));
+    m_overflowBlocks.push_back(m_overflowCurrent);
+    uintptr_t overflowBase = reinterpret_cast<uintptr_t>(m_overflowCurrent);
+    aligned = AlignUp(overflowBase, alignment);
+    m_overflowOffset = size_t(aligned + size - overflowBase);
+    m_used += m_overflowOffset;
+    m_peakUsed = std::max(m_peakUsed, m_used);
+    return reinterpret_cast<void*>(aligned);
+}
+
+void LinearArena::Reset()
+{
+    if (!m_overflowBlocks.empty()) {
+        for (unsigned char* block : m_overflowBlocks) {
+            ::operator delete(block);
+        }
+        m_overflowBlocks.clear();
+        m_overflowCurrent = nullptr;
+        m_overflowOffset = 0;
+        m_overflowCapacity = 0;
+
+        // 扩到峰值用量的 1.5 倍，之后的帧都落在主块里
+        size_t capacity = std::max(m_capacity * 2, m_peakUsed + m_peakUsed / 2);
+        ::operator delete(m_base);
+        m_base = static_cast<unsigned char*>(::operator new(capacity));
+        m_capacity = capacity;
+    }
+    m_offset = 0;
+    m_used = 0;
+}
+
+FrameArena::FrameArena(size_t capacity)
+    : m_arenas{ { capacity }, { capacity } }, m_current(0)
+{
+}
+
+void FrameArena::BeginFrame()
+{
+    m_current ^= 1;
+    m_arenas[m_current].Reset();
+}
@@ -0,0 +1,212 @@
+#include "FramePacer.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+namespace {
+
+// 睡眠醒来的误差由最后这段自旋吸收
+const double kSpinSeconds = 0.001;
+
+const char* const kModeNames[] = { "vsync", "adaptive", "uncapped", "limited", "low-latency" };
+
+}
+
+FrameTimeHistogram::FrameTimeHistogram()
+{
+    Reset();
+}
+
+void FrameTimeHistogram::Add(double milliseconds)
+{
+    int bucket = std::min(int(milliseconds / kBucketMilliseconds), kBucketCount - 1);
+    m_buckets[std::max(bucket, 0)]++;
+    m_count++;
+    m_total += milliseconds;
+    m_max = std::max(m_max, milliseconds);
+}
+
+void FrameTimeHistogram::Reset()
+{
+    std::memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_total = 0.0;
+    m_max = 0.0;
+}
+
+double FrameTimeHistogram::GetPercentile(double p) const
+{
+    if (m_count == 0) return 0.0;
+    size_t target = size_t(std::ceil(p * double(m_count)));
+    size_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        seen += m_buckets[i];
+        if (seen >= target && seen > 0) {
+            return i == kBucketCount - 1 ? m_max : (i + 1) * kBucketMilliseconds;
+        }
+    }
+    return m_max;
+}
+
+FramePacer::FramePacer()
+    : m_mode(FramePacing::VSync), m_refreshInterval(1.0 / 60.0), m_targetInterval(1.0 / 60.0)
+    , m_nextDeadline(0.0), m_lastFrameStart(-1.0), m_deltaTime(1.0 / 60.0), m_skipNextSample(true)
+    , m_fence(0), m_timer(nullptr)
+{
+}
+
+FramePacer::~FramePacer()
+{
+    ReleaseFence();
+#ifdef _WIN32
+    if (m_timer) {
+        CloseHandle(m_timer);
+    }
+#endif
+}
+
+void FramePacer::Initialize(double refreshRate)
+{
+    if (refreshRate > 0.0) {
+        m_refreshInterval = 1.0 / refreshRate;
+    }
+#ifdef _WIN32
+    // 默认的 Sleep 精度是 15.6ms，高精度可等待定时器（Windows 10 1803+）才能按毫秒以下睡眠
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+}
+
+void FramePacer::SetMode(FramePacing mode, double targetFps)
+{
+    int interval = 1;
+    if (mode == FramePacing::AdaptiveVSync) {
+        if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+            interval = -1;
+        } else {
+            std::cout << "FramePacer: swap_control_tear not supported, adaptive vsync falls back to vsync" << std::endl;
+        }
+    } else if (mode == FramePacing::Uncapped || mode == FramePacing::Limited) {
+        interval = 0;
+    }
+    glfwSwapInterval(interval);
+
+    if (mode != FramePacing::LowLatency) {
+        ReleaseFence();
+    }
+    m_mode = mode;
+    m_targetInterval = targetFps > 0.0 ? 1.0 / targetFps : m_refreshInterval;
+    m_nextDeadline = glfwGetTime();
+    m_skipNextSample = true;
+}
+
+void FramePacer::WaitUntil(double deadline)
+{
+    double remaining = deadline - glfwGetTime() - kSpinSeconds;
+    if (remaining > 0.0) {
+#ifdef _WIN32
+        if (m_timer) {
+            // 相对时间，以 100ns 为单位取负值
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -LONGLONG(remaining * 1.0e7);
+            if (SetWaitableTimerEx(m_timer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+                WaitForSingleObject(m_timer, INFINITE);
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+        }
+#else
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+#endif
+    }
+    while (glfwGetTime() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::ReleaseFence()
+{
+    if (m_fence) {
+        glDeleteSync(m_fence);
+        m_fence = 0;
+    }
+}
+
+double FramePacer::BeginFrame()
+{
+    if (m_mode == FramePacing::Limited) {
+        m_nextDeadline += m_targetInterval;
+        double now = glfwGetTime();
+        // 落后超过一帧（加载、断点）时从现在重新计时，不连续补帧
+        if (m_nextDeadline < now - m_targetInterval) {
+            m_nextDeadline = now;
+        }
+        WaitUntil(m_nextDeadline);
+    } else if (m_mode == FramePacing::LowLatency && m_fence) {
+        // 上一帧在 GPU 上完成之前不开始新的一帧，队列中至多一帧
+        glClientWaitSync(m_fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(100000000));
+        ReleaseFence();
+    }
+
+    double now = glfwGetTime();
+    double interval = m_lastFrameStart >= 0.0 ? now - m_lastFrameStart : m_refreshInterval;
+    m_lastFrameStart = now;
+    if (m_skipNextSample) {
+        m_skipNextSample = false;
+    } else {
+        m_histograms[int(m_mode)].Add(interval * 1000.0);
+    }
+
+    // 同步刷新时实际显示间隔是刷新周期的整数倍，限帧时是目标间隔的整数倍，把测量值对齐过去
+    if (m_mode != FramePacing::Uncapped) {
+        double period = m_mode == FramePacing::Limited ? m_targetInterval : m_refreshInterval;
+        double periods = std::max(1.0, std::round(interval / period));
+        m_deltaTime = std::fabs(interval - periods * period) < 0.1 * period ? periods * period : interval;
+    } else {
+        m_deltaTime = interval;
+    }
+    // 调试断点或窗口拖动之后不要一次推进太多
+    m_deltaTime = std::min(m_deltaTime, 0.1);
+    return now;
+}
+
+void FramePacer::EndFrame(GLFWwindow* context)
+{
+    if (m_mode == FramePacing::LowLatency) {
+        // 栅栏只覆盖创建它的上下文的命令流，固定放在主上下文中；保持它为当前，
+        // 下一帧 BeginFrame 的 GL_SYNC_FLUSH_COMMANDS_BIT 才会刷新到这个栅栏
+        if (glfwGetCurrentContext() != context) {
+            glfwMakeContextCurrent(context);
+        }
+        ReleaseFence();
+        m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+const char* FramePacer::GetModeName(FramePacing mode)
+{
+    return kModeNames[int(mode)];
+}
+
+bool FramePacer::ParseMode(const char* name, FramePacing& mode)
+{
+    for (int i = 0; i < int(FramePacing::Count); i++) {
+        if (std::strcmp(name, kModeNames[i]) == 0) {
+            mode = FramePacing(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,369 @@
+#include "FrameRecorder.h"
+#include "ImageWriter.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+namespace {
+
+unsigned char ClampByte(int v)
+{
+    return static_cast<unsigned char>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+bool EndsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}
+
+FrameRecorder::FrameRecorder()
+    : m_format(RecordFormat::Y4M), m_file(nullptr)
+    , m_width(0), m_height(0), m_fps(60), m_recording(false)
+    , m_nextSlot(0), m_capturedFrames(0), m_pendingHead(0), m_pendingCount(0)
+    , m_stopping(false), m_workerCount(0)
+    , m_writtenFrames(0), m_stallSeconds(0.0), m_workerSeconds(0.0) {
+}
+
+FrameRecorder::~FrameRecorder() {
+    Stop();
+}
+
+RecordFormat FrameRecorder::FormatFromPath(const std::string& path) {
+    if (path == "-" || EndsWith(path, ".y4m")) return RecordFormat::Y4M;
+    if (EndsWith(path, ".rgba") || EndsWith(path, ".raw")) return RecordFormat::RawRGBA;
+    return RecordFormat::PNGSequence;
+}
+
+bool FrameRecorder::Start(const std::string& output, RecordFormat format, int width, int height,
+                          int fps, int ringSize, int encoderThreads) {
+    if (m_recording) {
+        Stop();
+    }
+    if (width <= 0 || height <= 0 || ringSize < 1) {
+        std::cerr << "FrameRecorder: Invalid recording parameters!" << std::endl;
+        return false;
+    }
+
+    m_format = format;
+    m_output = output;
+    m_width = width;
+    m_height = height;
+    m_fps = fps > 0 ? fps : 60;
+
+    if (format != RecordFormat::PNGSequence) {
+        if (output == "-") {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            m_file = stdout;
+        } else {
+            m_file = std::fopen(output.c_str(), "wb");
+        }
+        if (!m_file) {
+            std::cerr << "FrameRecorder: Failed to open " << output << std::endl;
+            return false;
+        }
+        if (format == RecordFormat::Y4M) {
+            std::fprintf(m_file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", m_width, m_height, m_fps);
+        }
+    }
+
+    m_slots.resize(ringSize);
+    if (!CreateSlots()) {
+        std::cerr << "FrameRecorder: Failed to create pixel pack buffers!" << std::endl;
+        DestroySlots();
+        if (m_file && m_file != stdout) std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+
+    int workerCount = 1;
+    if (format == RecordFormat::PNGSequence) {
+        workerCount = encoderThreads > 0 ? encoderThreads : int(std::thread::hardware_concurrency());
+        workerCount = std::max(workerCount, 1);
+    }
+    m_workerCount = workerCount;
+
+    const size_t frameBytes = size_t(m_width) * m_height * 4;
+    m_framePool.resize(ringSize + workerCount * 2);
+    m_freeFrames.clear();
+    for (Frame& frame : m_framePool) {
+        frame.pixels.resize(frameBytes);
+        m_freeFrames.push_back(&frame);
+    }
+    m_pendingFrames.assign(m_framePool.size(), nullptr);
+    m_pendingHead = 0;
+    m_pendingCount = 0;
+
+    const int chromaWidth = (m_width + 1) / 2;
+    const int chromaHeight = (m_height + 1) / 2;
+    m_yuvBuffer.resize(size_t(m_width) * m_height + size_t(chromaWidth) * chromaHeight * 2);
+
+    m_nextSlot = 0;
+    m_capturedFrames = 0;
+    m_writtenFrames = 0;
+    m_stallSeconds = 0.0;
+    m_workerSeconds = 0.0;
+    m_stopping = false;
+    m_startTime = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < workerCount; i++) {
+        m_workers.emplace_back(&FrameRecorder::WorkerLoop, this);
+    }
+
+    m_recording = true;
+    std::cerr << "FrameRecorder: Recording " << m_width << "x" << m_height << " to " << output
+              << " (" << ringSize << " PBOs, " << workerCount << " writer threads)" << std::endl;
+    return true;
+}
+
+bool FrameRecorder::CreateSlots() {
+    const GLsizeiptr frameBytes = GLsizeiptr(m_width) * m_height * 4;
+    for (Slot& slot : m_slots) {
+        slot.fence = 0;
+        slot.frameIndex = -1;
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void FrameRecorder::DestroySlots() {
+    for (Slot& slot : m_slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+            slot.fence = 0;
+        }
+        if (slot.pbo) {
+            glDeleteBuffers(1, &slot.pbo);
+            slot.pbo = 0;
+        }
+    }
+    m_slots.clear();
+}
+
+void FrameRecorder::CaptureFrame() {
+    if (!m_recording) return;
+
+    const int ringSize = int(m_slots.size());
+    Slot& slot = m_slots[m_nextSlot];
+
+    // 环形队列已满：只能等待最老的一帧回读完成
+    if (slot.fence) {
+        ReadbackSlot(slot, true);
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frameIndex = m_capturedFrames++;
+
+    m_nextSlot = (m_nextSlot + 1) % ringSize;
+
+    // 按提交顺序非阻塞地收取已经完成的帧，遇到未完成的立即停止以保证顺序
+    for (int k = 0; k < ringSize - 1; k++) {
+        Slot& pending = m_slots[(m_nextSlot + k) % ringSize];
+        if (!pending.fence) continue;
+        if (!ReadbackSlot(pending, false)) break;
+    }
+}
+
+bool FrameRecorder::ReadbackSlot(Slot& slot, bool wait) {
+    auto stallStart = std::chrono::steady_clock::now();
+
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (wait && status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    if (status == GL_WAIT_FAILED) {
+        std::cerr << "FrameRecorder: glClientWaitSync failed, dropping frame " << slot.frameIndex << std::endl;
+        glDeleteSync(slot.fence);
+        slot.fence = 0;
+        return true;
+    }
+
+    Frame* frame = AcquireFrame();
+    m_stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stallStart).count();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const GLsizeiptr frameBytes = GLsizeiptr(m_width) * m_height * 4;
+    void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT);
+    if (mapped) {
+        std::memcpy(frame->pixels.data(), mapped, size_t(frameBytes));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (mapped) {
+        frame->index = slot.frameIndex;
+        m_pendingFrames[(m_pendingHead + m_pendingCount) % m_pendingFrames.size()] = frame;
+        m_pendingCount++;
+        m_frameReady.notify_one();
+    } else {
+        m_freeFrames.push_back(frame);
+    }
+    return true;
+}
+
+FrameRecorder::Frame* FrameRecorder::AcquireFrame() {
+    // 写出线程跟不上时在这里反压渲染线程，而不是无限增长内存
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_frameFree.wait(lock, [this] { return !m_freeFrames.empty(); });
+    Frame* frame = m_freeFrames.back();
+    m_freeFrames.pop_back();
+    return frame;
+}
+
+void FrameRecorder::WorkerLoop() {
+    std::vector<unsigned char> png;
+
+    for (;;) {
+        Frame* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_frameReady.wait(lock, [this] { return m_stopping || m_pendingCount > 0; });
+            if (m_pendingCount == 0) return;
+            frame = m_pendingFrames[m_pendingHead];
+            m_pendingHead = (m_pendingHead + 1) % m_pendingFrames.size();
+            m_pendingCount--;
+        }
+
+        auto workStart = std::chrono::steady_clock::now();
+        switch (m_format) {
+        case RecordFormat::Y4M:
+            WriteY4MFrame(*frame);
+            break;
+        case RecordFormat::RawRGBA:
+            WriteRawFrame(*frame);
+            break;
+        case RecordFormat::PNGSequence: {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%06d.png", frame->index);
+            if (ImageWriter::encodePNG(m_width, m_height, 4, frame->pixels.data(), true, png)) {
+                FILE* file = std::fopen((m_output + name).c_str(), "wb");
+                if (file) {
+                    std::fwrite(png.data(), 1, png.size(), file);
+                    std::fclose(file);
+                } else {
+                    std::cerr << "FrameRecorder: Failed to write " << m_output << name << std::endl;
+                }
+            }
+            break;
+        }
+        }
+        double workSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - workStart).count();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_workerSeconds += workSeconds;
+        m_writtenFrames++;
+        m_freeFrames.push_back(frame);
+        m_frameFree.notify_one();
+    }
+}
+
+void FrameRecorder::WriteY4MFrame(const Frame& frame) {
+    const int chromaWidth = (m_width + 1) / 2;
+    const int chromaHeight = (m_height + 1) / 2;
+    unsigned char* yPlane = m_yuvBuffer.data();
+    unsigned char* uPlane = yPlane + size_t(m_width) * m_height;
+    unsigned char* vPlane = uPlane + size_t(chromaWidth) * chromaHeight;
+    const size_t stride = size_t(m_width) * 4;
+
+    // glReadPixels 的行序自下而上，这里翻转为自上而下；BT.601 全范围 (JPEG) 系数
+    for (int y = 0; y < m_height; y++) {
+        const unsigned char* src = frame.pixels.data() + stride * (m_height - 1 - y);
+        unsigned char* dst = yPlane + size_t(m_width) * y;
+        for (int x = 0; x < m_width; x++) {
+            const unsigned char* p = src + x * 4;
+            dst[x] = ClampByte((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+        }
+    }
+
+    for (int cy = 0; cy < chromaHeight; cy++) {
+        int y0 = cy * 2;
+        int y1 = std::min(y0 + 1, m_height - 1);
+        const unsigned char* row0 = frame.pixels.data() + stride * (m_height - 1 - y0);
+        const unsigned char* row1 = frame.pixels.data() + stride * (m_height - 1 - y1);
+        for (int cx = 0; cx < chromaWidth; cx++) {
+            int x0 = cx * 2 * 4;
+            int x1 = std::min(cx * 2 + 1, m_width - 1) * 4;
+            int r = (row0[x0] + row0[x1] + row1[x0] + row1[x1] + 2) >> 2;
+            int g = (row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1] + 2) >> 2;
+            int b = (row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2] + 2) >> 2;
+            size_t i = size_t(chromaWidth) * cy + cx;
+            uPlane[i] = ClampByte(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128);
+            vPlane[i] = ClampByte(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128);
+        }
+    }
+
+    std::fputs("FRAME\n", m_file);
+    std::fwrite(m_yuvBuffer.data(), 1, m_yuvBuffer.size(), m_file);
+}
+
+void FrameRecorder::WriteRawFrame(const Frame& frame) {
+    const size_t stride = size_t(m_width) * 4;
+    for (int y = m_height - 1; y >= 0; y--) {
+        std::fwrite(frame.pixels.data() + stride * y, 1, stride, m_file);
+    }
+}
+
+void FrameRecorder::Stop() {
+    if (!m_recording) return;
+
+    const int ringSize = int(m_slots.size());
+    for (int k = 0; k < ringSize; k++) {
+        Slot& pending = m_slots[(m_nextSlot + k) % ringSize];
+        if (pending.fence) {
+            ReadbackSlot(pending, true);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_frameReady.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+
+    if (m_file) {
+        std::fflush(m_file);
+        if (m_file != stdout) std::fclose(m_file);
+        m_file = nullptr;
+    }
+    DestroySlots();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    double recordFps = elapsed > 0.0 ? m_writtenFrames / elapsed : 0.0;
+    // 写出线程的纯处理吞吐，不受渲染帧率限制
+    double writerFps = m_workerSeconds > 0.0 ? m_writtenFrames * m_workerCount / m_workerSeconds : 0.0;
+
+    std::cerr << "FrameRecorder: " << m_writtenFrames << " frames at " << m_width << "x" << m_height
+              << ", recorded " << recordFps << " fps, writer throughput " << writerFps
+              << " fps, readback stall " << m_stallSeconds * 1000.0 << " ms" << std::endl;
+
+    m_framePool.clear();
+    m_freeFrames.clear();
+    m_pendingFrames.clear();
+    m_pendingCount = 0;
+    m_recording = false;
+}
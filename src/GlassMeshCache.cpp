@@ -0,0 +1,207 @@
+#include "GlassMeshCache.h"
+#include <iostream>
+#include <cmath>
+
+namespace {
+
+constexpr int kSegmentLevels[] = { 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256 };
+
+const int kRimVertices = GlassMeshCache::kRimVertices;
+const int kQuadFirstVertex = 1 + kRimVertices;
+const int kVertexCount = kQuadFirstVertex + 4;
+
+constexpr bool RimCoversSegmentLevels()
+{
+    for (int level : kSegmentLevels) {
+        if (kRimVertices % level != 0) return false;
+    }
+    return true;
+}
+static_assert(RimCoversSegmentLevels(), "every segment level must pick an exact subset of the rim vertices");
+static_assert(kVertexCount <= 65536, "indices are 16-bit");
+
+/**
+ * 顶点表：中心、半径 0.5 的圆周等分点、[-0.5, 0.5] 包围盒的四角
+ * 圆周点在每个象限起点取精确值，象限内用旋转递推（double，误差远小于 float 精度）
+ */
+struct GlassVertexTable {
+    GlassVertex vertices[kVertexCount];
+
+    constexpr GlassVertexTable() : vertices()
+    {
+        const double step = 2.0 * 3.14159265358979323846 / kRimVertices;
+        // 步长很小，泰勒展开几项就足够
+        double cosStep = 1.0 - step * step / 2.0 + step * step * step * step / 24.0
+                       - step * step * step * step * step * step / 720.0;
+        double sinStep = step - step * step * step / 6.0 + step * step * step * step * step / 120.0;
+
+        const int quadrant = kRimVertices / 4;
+        const double axes[4][2] = { { 1.0, 0.0 }, { 0.0, 1.0 }, { -1.0, 0.0 }, { 0.0, -1.0 } };
+        double c = 1.0;
+        double s = 0.0;
+        for (int i = 0; i < kRimVertices; i++) {
+            if (i % quadrant == 0) {
+                c = axes[i / quadrant][0];
+                s = axes[i / quadrant][1];
+            }
+            vertices[1 + i] = { float(c * 0.5), float(s * 0.5) };
+            double next = c * cosStep - s * sinStep;
+            s = s * cosStep + c * sinStep;
+            c = next;
+        }
+
+        vertices[kQuadFirstVertex + 0] = { -0.5f, -0.5f };
+        vertices[kQuadFirstVertex + 1] = {  0.5f, -0.5f };
+        vertices[kQuadFirstVertex + 2] = {  0.5f,  0.5f };
+        vertices[kQuadFirstVertex + 3] = { -0.5f,  0.5f };
+    }
+};
+
+constexpr GlassVertexTable kVertexTable;
+
+glm::vec2 ToScreen(const glm::vec4& clip, int screenWidth, int screenHeight)
+{
+    return glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * screenWidth,
+                     (clip.y / clip.w * 0.5f + 0.5f) * screenHeight);
+}
+
+}
+
+GlassMeshCache::GlassMeshCache() : m_vertexBuffer(0)
+{
+}
+
+GlassMeshCache::~GlassMeshCache()
+{
+    Cleanup();
+}
+
+int GlassMeshCache::SegmentsForRadius(float radiusPixels, float maxErrorPixels)
+{
+    if (radiusPixels <= maxErrorPixels) {
+        return kMinSegments;
+    }
+
+    // 弦高 r * (1 - cos(pi / n)) <= maxError
+    float halfAngle = std::acos(1.0f - maxErrorPixels / radiusPixels);
+    int segments = static_cast<int>(std::ceil(3.1415926f / halfAngle));
+
+    for (int level : kSegmentLevels) {
+        if (segments <= level) {
+            return level;
+        }
+    }
+    return kMaxSegments;
+}
+
+float GlassMeshCache::ProjectedRadius(const glm::mat4& mvp, int screenWidth, int screenHeight)
+{
+    glm::vec4 center = mvp * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    glm::vec4 edgeX = mvp * glm::vec4(0.5f, 0.0f, 0.0f, 1.0f);
+    glm::vec4 edgeY = mvp * glm::vec4(0.0f, 0.5f, 0.0f, 1.0f);
+
+    // 跨越近平面时无法可靠估计，按最大精度处理
+    if (center.w <= 0.0f || edgeX.w <= 0.0f || edgeY.w <= 0.0f) {
+        return float(glm::max(screenWidth, screenHeight));
+    }
+
+    glm::vec2 c = ToScreen(center, screenWidth, screenHeight);
+    float rx = glm::length(ToScreen(edgeX, screenWidth, screenHeight) - c);
+    float ry = glm::length(ToScreen(edgeY, screenWidth, screenHeight) - c);
+    return glm::max(rx, ry);
+}
+
+const GlassMesh* GlassMeshCache::Acquire(const GlassMeshKey& key)
+{
+    auto it = m_meshes.find(key.Hash());
+    if (it != m_meshes.end()) {
+        it->second.refCount++;
+        return &it->second;
+    }
+
+    // VAO 不可拷贝，直接在表中构建
+    GlassMesh& mesh = m_meshes[key.Hash()];
+    if (!BuildMesh(key, mesh)) {
+        std::cout << "GlassMeshCache: Failed to build mesh with " << key.segments << " segments!" << std::endl;
+        m_meshes.erase(key.Hash());
+        return nullptr;
+    }
+    mesh.refCount = 1;
+    return &mesh;
+}
+
+void GlassMeshCache::Release(const GlassMeshKey& key)
+{
+    auto it = m_meshes.find(key.Hash());
+    if (it == m_meshes.end()) return;
+
+    if (--it->second.refCount > 0) return;
+
+    it->second.vao.Cleanup();
+    glDeleteBuffers(1, &it->second.ebo);
+    m_meshes.erase(it);
+}
+
+bool GlassMeshCache::BuildMesh(const GlassMeshKey& key, GlassMesh& mesh)
+{
+    // 最多 kRimVertices 个三角形，索引放在栈上
+    uint16_t indices[kRimVertices * 3];
+    int indexCount = 0;
+
+    if (key.shape == GlassMeshShape::BoundingQuad) {
+        // SDF 已经定义了轮廓，只需覆盖 [-0.5, 0.5] 的包围盒
+        const uint16_t quad[] = { 0, 1, 2, 2, 3, 0 };
+        for (uint16_t index : quad) {
+            indices[indexCount++] = uint16_t(kQuadFirstVertex + index);
+        }
+    } else {
+        if (key.segments < 3 || key.segments > kRimVertices) return false;
+
+        // 中心点 + 每段一个边缘点（首尾通过索引闭合）；分段数不整除边缘点数时取最近的边缘点
+        const int segments = key.segments;
+        for (int i = 0; i < segments; i++) {
+            int current = (i * kRimVertices + segments / 2) / segments;
+            int next = ((i + 1) * kRimVertices + segments / 2) / segments % kRimVertices;
+            indices[indexCount++] = 0;
+            indices[indexCount++] = uint16_t(1 + current);
+            indices[indexCount++] = uint16_t(1 + next);
+        }
+    }
+
+    if (!m_vertexBuffer) {
+        glGenBuffers(1, &m_vertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(kVertexTable.vertices), kVertexTable.vertices, GL_STATIC_DRAW);
+    }
+
+    glGenBuffers(1, &mesh.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(uint16_t), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    GLuint vertexBuffer = m_vertexBuffer;
+    GLuint elementBuffer = mesh.ebo;
+    mesh.vao.Initialize([vertexBuffer, elementBuffer]() {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GlassVertex), (void*)0);
+        glEnableVertexAttribArray(0);
+    });
+
+    mesh.indexCount = static_cast<GLsizei>(indexCount);
+    mesh.indexType = GL_UNSIGNED_SHORT;
+    return true;
+}
+
+void GlassMeshCache::Cleanup()
+{
+    for (auto& entry : m_meshes) {
+        entry.second.vao.Cleanup();
+        glDeleteBuffers(1, &entry.second.ebo);
+    }
+    m_meshes.clear();
+    if (m_vertexBuffer) {
+        glDeleteBuffers(1, &m_vertexBuffer);
+        m_vertexBuffer = 0;
+    }
+}
@@ -0,0 +1,56 @@
+#include "GlassMotion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 速度逼近目标速度的响应系数（1/秒），起停有约 50ms 的缓动
+const float kResponse = 20.0f;
+const int kMaxStepsPerAdvance = 8;
+
+}
+
+GlassMotion::GlassMotion(const glm::vec2& position, float speed, double step)
+    : m_position(position), m_previousPosition(position), m_velocity(0.0f), m_direction(0.0f)
+    , m_speed(speed), m_step(step), m_stepTime(0.0), m_started(false)
+{
+}
+
+int GlassMotion::Advance(double time)
+{
+    if (!m_started) {
+        m_stepTime = time;
+        m_started = true;
+        return 0;
+    }
+
+    int steps = 0;
+    const float dt = float(m_step);
+    // 指数逼近的离散形式，与步长无关地收敛到目标速度
+    const float blend = 1.0f - std::exp(-kResponse * dt);
+    while (time - m_stepTime >= m_step) {
+        if (steps == kMaxStepsPerAdvance) {
+            m_stepTime = time;
+            break;
+        }
+        glm::vec2 targetVelocity = m_direction * m_speed;
+        m_velocity += (targetVelocity - m_velocity) * blend;
+        if (m_direction == glm::vec2(0.0f) && glm::dot(m_velocity, m_velocity) < 1e-8f) {
+            m_velocity = glm::vec2(0.0f);
+        }
+
+        m_previousPosition = m_position;
+        m_position += m_velocity * dt;
+        m_stepTime += m_step;
+        steps++;
+    }
+    return steps;
+}
+
+glm::vec2 GlassMotion::Interpolate(const glm::vec2& previous, const glm::vec2& current,
+                                   double stepTime, double step, double renderTime)
+{
+    if (step <= 0.0) return current;
+    float alpha = float(std::min(1.0, std::max(0.0, (renderTime - stepTime) / step)));
+    return previous + (current - previous) * alpha;
+}
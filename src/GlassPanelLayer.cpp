@@ -0,0 +1,324 @@
+#include "GlassPanelLayer.h"
+#include "ResolutionManager.h"
+#include "Shader.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+GlassPanelLayer::GlassPanelLayer()
+    : m_atlas(nullptr), m_mergeRadius(0.0f), m_mergeLimitReported(false)
+    , m_tiledProgram{ 0, -1, -1, -1 }, m_mergedProgram{ 0, -1, -1, -1 }, m_mergeRadiusLocation(-1)
+{
+}
+
+GlassPanelLayer::~GlassPanelLayer()
+{
+    Cleanup();
+}
+
+GlassPanelLayer::ViewState::ViewState()
+    : resolution(nullptr), instanceData(nullptr), instanceCount(0), tileRanges{ 0, 0, 0 }, tileInstances{ 0, 0, 0 }, instances{ 0, 0, 0 }, elementBuffer(0)
+{
+}
+
+GlassPanelLayer::ViewState::~ViewState()
+{
+    Cleanup();
+}
+
+void GlassPanelLayer::ViewState::Cleanup()
+{
+    DeleteBuffer(tileRanges);
+    DeleteBuffer(tileInstances);
+    DeleteBuffer(instances);
+    if (elementBuffer) {
+        glDeleteBuffers(1, &elementBuffer);
+        elementBuffer = 0;
+    }
+}
+
+bool GlassPanelLayer::LoadProgram(const char* fragmentPath, Program& program)
+{
+    Shader shader("shaders/liquid_glass_tiled.vert", fragmentPath);
+    program.id = shader.ID;
+    if (!program.id) {
+        std::cout << "GlassPanelLayer: Failed to load " << fragmentPath << std::endl;
+        return false;
+    }
+
+    glUseProgram(program.id);
+    glUniform1i(glGetUniformLocation(program.id, "captureTexture"), 0);
+    glUniform1i(glGetUniformLocation(program.id, "tileRanges"), 1);
+    glUniform1i(glGetUniformLocation(program.id, "tileInstances"), 2);
+    glUniform1i(glGetUniformLocation(program.id, "instanceData"), 3);
+    glUniform1i(glGetUniformLocation(program.id, "sdfAtlas"), 4);
+    glUniform1i(glGetUniformLocation(program.id, "tileSize"), GlassTileBinner::kTileSize);
+    glUniform1f(glGetUniformLocation(program.id, "atlasSpread"), float(SDFAtlas::kSpread));
+    program.rectLocation = glGetUniformLocation(program.id, "rect");
+    program.screenSizeLocation = glGetUniformLocation(program.id, "screenSize");
+    program.tilesXLocation = glGetUniformLocation(program.id, "tilesX");
+    glUseProgram(0);
+    return true;
+}
+
+bool GlassPanelLayer::Initialize()
+{
+    if (!LoadProgram("shaders/liquid_glass_tiled.frag", m_tiledProgram) ||
+        !LoadProgram("shaders/liquid_glass_merged.frag", m_mergedProgram)) {
+        return false;
+    }
+
+    GLuint blockIndex = glGetUniformBlockIndex(m_mergedProgram.id, "GlassElements");
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(m_mergedProgram.id, blockIndex, 0);
+    }
+    m_mergeRadiusLocation = glGetUniformLocation(m_mergedProgram.id, "mergeRadius");
+
+    // 核心模式下即使没有顶点属性也必须绑定 VAO
+    m_vao.Initialize(nullptr);
+    return true;
+}
+
+void GlassPanelLayer::Cleanup()
+{
+    m_vao.Cleanup();
+    for (Program* program : { &m_tiledProgram, &m_mergedProgram }) {
+        if (program->id) {
+            glDeleteProgram(program->id);
+            program->id = 0;
+        }
+    }
+}
+
+size_t GlassPanelLayer::AddPanel(const GlassPanel& panel)
+{
+    m_panels.push_back(panel);
+    return m_panels.size() - 1;
+}
+
+float GlassPanelLayer::GetInfluenceMargin() const
+{
+    float margin = 0.0f;
+    for (const GlassPanel& panel : m_panels) {
+        margin = std::max(margin, std::fabs(panel.refLength - panel.refHeight) + 1.0f);
+    }
+    return margin + (m_mergeRadius > 0.0f ? m_mergeRadius * 1.25f : 0.0f);
+}
+
+void GlassPanelLayer::BuildInstances(ViewState& state, FrameArena& arena, const glm::mat4& projection,
+                                     const glm::mat4& view, int screenWidth, int screenHeight)
+{
+    size_t count = m_panels.size();
+    if (m_mergeRadius > 0.0f && count > kMaxMergedPanels) {
+        if (!m_mergeLimitReported) {
+            std::cerr << "GlassPanelLayer: Merged mode renders only the first " << kMaxMergedPanels
+                      << " of " << count << " panels" << std::endl;
+            m_mergeLimitReported = true;
+        }
+        count = kMaxMergedPanels;
+    }
+    // 包围盒只在分桶时用到，实例数据留到本帧的着色 pass 上传，都从帧分配器取，稳定后不再分配
+    GlassTileBounds* allBounds = arena.AllocateArray<GlassTileBounds>(count);
+    glm::vec4* instanceData = arena.AllocateArray<glm::vec4>(count * kInstanceStride);
+    state.instanceData = instanceData;
+    state.instanceCount = count * kInstanceStride;
+
+    // smooth-min 使场值最多降低 k/4，只有距离小于 k + k/4 的面板可能影响某个像素
+    float influence = m_mergeRadius > 0.0f ? m_mergeRadius * 1.25f : 0.0f;
+
+    glm::mat4 viewProjection = projection * view;
+    for (size_t i = 0; i < count; i++) {
+        const GlassPanel& panel = m_panels[i];
+        GlassTileBounds& bounds = allBounds[i];
+
+        // 投影四个角取包围盒；有角落在相机后方时整块跳过
+        glm::vec2 minPixel(1e30f), maxPixel(-1e30f);
+        bool visible = true;
+        for (int corner = 0; corner < 4; corner++) {
+            glm::vec2 local((corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f);
+            glm::vec4 clip = viewProjection * glm::vec4(panel.position + local * panel.size, 0.0f, 1.0f);
+            if (clip.w <= 0.0f) {
+                visible = false;
+                break;
+            }
+            glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+            glm::vec2 pixel((ndc.x * 0.5f + 0.5f) * screenWidth, (ndc.y * 0.5f + 0.5f) * screenHeight);
+            minPixel = glm::min(minPixel, pixel);
+            maxPixel = glm::max(maxPixel, pixel);
+        }
+        if (!visible) {
+            bounds = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+            std::fill_n(instanceData + i * kInstanceStride, kInstanceStride, glm::vec4(0.0f));
+            continue;
+        }
+
+        // 折射偏移 (ref_height - dis) * (ref_length / ref_height - 1) 在边缘处最大，为 |ref_length - ref_height|，
+        // 再加一个像素给线性过滤
+        float margin = std::fabs(panel.refLength - panel.refHeight) + 1.0f;
+
+        // 圆形按半尺寸相等、圆角取满的圆角矩形编码，着色器只需一种 SDF
+        glm::vec2 center = (minPixel + maxPixel) * 0.5f;
+        glm::vec2 halfSize = (maxPixel - minPixel) * 0.5f;
+        float radius = glm::clamp(panel.cornerRadius, 0.0f, 1.0f) * glm::min(halfSize.x, halfSize.y);
+        if (panel.shape == GlassPanelShape::Circle) {
+            halfSize = glm::vec2(glm::min(halfSize.x, halfSize.y));
+            radius = halfSize.x;
+        }
+        bounds = { center.x - halfSize.x - influence, center.y - halfSize.y - influence,
+                   center.x + halfSize.x + influence, center.y + halfSize.y + influence, margin };
+        // 图集形状在第二个 vec4 的 w 中记录层号 + 1（0 表示解析形状），第三个 vec4 为 UV 矩形
+        float layer = 0.0f;
+        glm::vec4 uvRect(0.0f);
+        if (panel.shape == GlassPanelShape::Atlas && m_atlas && m_atlas->IsValid(panel.atlasEntry)) {
+            layer = float(m_atlas->GetLayer(panel.atlasEntry) + 1);
+            uvRect = m_atlas->GetUVRect(panel.atlasEntry);
+        }
+        glm::vec4* instance = instanceData + i * kInstanceStride;
+        instance[0] = glm::vec4(center, halfSize);
+        instance[1] = glm::vec4(radius, panel.refHeight, panel.refLength, layer);
+        instance[2] = uvRect;
+    }
+
+    state.binner.Bin(screenWidth, screenHeight, allBounds, count);
+}
+
+void GlassPanelLayer::AddPasses(ViewState& state, RenderGraph& graph, RenderResource target,
+                                const glm::mat4& projection, const glm::mat4& view)
+{
+    if (!m_tiledProgram.id || m_panels.empty()) return;
+
+    const RenderTextureDesc& targetDesc = graph.GetDesc(target);
+    BuildInstances(state, graph.GetFrameArena(), projection, view, targetDesc.width, targetDesc.height);
+    if (state.binner.GetShadeRects().empty()) return;
+
+    // 捕获只用到左下角与目标等大的区域，着色器按像素坐标寻址
+    RenderTextureDesc desc = { targetDesc.width, targetDesc.height, GL_RGBA8 };
+    if (state.resolution) {
+        desc.width = std::max(desc.width, state.resolution->GetTargetWidth());
+        desc.height = std::max(desc.height, state.resolution->GetTargetHeight());
+    }
+    RenderResource capture = graph.CreateTexture("PanelCapture", desc);
+
+    // pass 只引用本视图的 state，其他视图之后重新分桶不影响尚未执行的 pass
+    ViewState* viewState = &state;
+    graph.AddPass("PanelCapture", [=](const RenderPassContext& context) {
+        Capture(*viewState, context, target, capture);
+    }).Read(target).Write(capture);
+
+    const GlassPanelLayer* layer = this;
+    int screenWidth = targetDesc.width;
+    int screenHeight = targetDesc.height;
+    graph.AddPass("GlassPanels", [=](const RenderPassContext& context) {
+        layer->Shade(*viewState, context, capture, screenWidth, screenHeight);
+    }).Read(capture).Write(target);
+}
+
+void GlassPanelLayer::Capture(const ViewState& state, const RenderPassContext& context, RenderResource source,
+                              RenderResource capture)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, context.GetFramebuffer(source));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, context.GetFramebuffer(capture));
+    for (const GlassTileRect& rect : state.binner.GetCaptureRects()) {
+        int x1 = rect.x + rect.width;
+        int y1 = rect.y + rect.height;
+        glBlitFramebuffer(rect.x, rect.y, x1, y1, rect.x, rect.y, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+}
+
+void GlassPanelLayer::Shade(ViewState& state, const RenderPassContext& context, RenderResource capture,
+                            int screenWidth, int screenHeight) const
+{
+    bool merged = m_mergeRadius > 0.0f;
+    const Program& program = merged ? m_mergedProgram : m_tiledProgram;
+    const GlassTileBinner& binner = state.binner;
+
+    const std::vector<uint32_t>& ranges = binner.GetTileRanges();
+    const std::vector<uint32_t>& instances = binner.GetTileInstances();
+    UploadBuffer(state.tileRanges, GL_RG32UI, ranges.data(), ranges.size() * sizeof(uint32_t));
+    UploadBuffer(state.tileInstances, GL_R32UI, instances.data(), instances.size() * sizeof(uint32_t));
+    if (merged) {
+        if (!state.elementBuffer) {
+            glGenBuffers(1, &state.elementBuffer);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, state.elementBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, kMaxMergedPanels * kInstanceStride * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, state.instanceCount * sizeof(glm::vec4), state.instanceData);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, 0, state.elementBuffer);
+    } else {
+        UploadBuffer(state.instances, GL_RGBA32F, state.instanceData, state.instanceCount * sizeof(glm::vec4));
+    }
+
+    context.BindTarget();
+
+    GLboolean depthTestEnabled;
+    glGetBooleanv(GL_DEPTH_TEST, &depthTestEnabled);
+    GLboolean blendEnabled;
+    glGetBooleanv(GL_BLEND, &blendEnabled);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    glUseProgram(program.id);
+    glUniform1i(program.tilesXLocation, binner.GetTilesX());
+    glUniform2f(program.screenSizeLocation, float(screenWidth), float(screenHeight));
+    if (merged) {
+        glUniform1f(m_mergeRadiusLocation, m_mergeRadius);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, context.GetTexture(capture));
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, state.tileRanges.texture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, state.tileInstances.texture);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_BUFFER, state.instances.texture);
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_atlas ? m_atlas->GetTexture() : 0);
+
+    m_vao.Bind();
+    for (const GlassTileRect& rect : binner.GetShadeRects()) {
+        glUniform4f(program.rectLocation, float(rect.x), float(rect.y), float(rect.width), float(rect.height));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+    if (blendEnabled) {
+        glEnable(GL_BLEND);
+    }
+    if (depthTestEnabled) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
+
+void GlassPanelLayer::UploadBuffer(TextureBuffer& buffer, GLenum format, const void* data, size_t bytes)
+{
+    if (!buffer.buffer) {
+        glGenBuffers(1, &buffer.buffer);
+        glGenTextures(1, &buffer.texture);
+    }
+
+    // 每帧先废弃旧存储再写入，上一帧仍在读取的数据由驱动保留，不会与 GPU 同步等待
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer.buffer);
+    bool grow = bytes > buffer.capacity || buffer.capacity == 0;
+    if (grow) {
+        buffer.capacity = std::max<size_t>(std::max<size_t>(bytes, 256), buffer.capacity + buffer.capacity / 2);
+    }
+    glBufferData(GL_TEXTURE_BUFFER, buffer.capacity, nullptr, GL_STREAM_DRAW);
+    if (grow) {
+        glBindTexture(GL_TEXTURE_BUFFER, buffer.texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer.buffer);
+    }
+    if (bytes > 0) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void GlassPanelLayer::DeleteBuffer(TextureBuffer& buffer)
+{
+    if (buffer.texture) glDeleteTextures(1, &buffer.texture);
+    if (buffer.buffer) glDeleteBuffers(1, &buffer.buffer);
+    buffer = { 0, 0, 0 };
+}
@@ -0,0 +1,279 @@
+#include "GlassReferenceRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GLASS_REFERENCE_SSE2 1
+#endif
+
+namespace {
+
+float Saturate(float v)
+{
+    return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
+
+// 逐像素的颜色运算都是 RGBA 四路相同的计算：SSE2 下一个像素占一个寄存器，
+// 运算顺序与标量版本相同（无 FMA），两种实现的结果逐位一致
+#ifdef GLASS_REFERENCE_SSE2
+
+typedef __m128 Color;
+
+inline __m128 LoadTexel(const unsigned char* p)
+{
+    int bits;
+    std::memcpy(&bits, p, sizeof(bits));
+    __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), _mm_setzero_si128());
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+}
+
+inline Color Lerp(Color a, Color b, float t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+}
+
+inline Color ScaleRGB(Color c, float s)
+{
+    return _mm_mul_ps(c, _mm_setr_ps(s, s, s, 1.0f));
+}
+
+inline Color ScaleRGBA(Color c, float s)
+{
+    return _mm_mul_ps(c, _mm_set1_ps(s));
+}
+
+// GL_SRC_ALPHA / GL_ONE_MINUS_SRC_ALPHA 混合，定点帧缓冲先钳制源颜色；
+// 钳制后的源乘以 alpha，alpha 通道正好是 alpha * alpha
+inline void BlendPixel(unsigned char* out, Color color)
+{
+    __m128 src = _mm_min_ps(_mm_max_ps(color, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    __m128 alpha = _mm_shuffle_ps(src, src, _MM_SHUFFLE(3, 3, 3, 3));
+    __m128 dst = _mm_mul_ps(LoadTexel(out), _mm_set1_ps(1.0f / 255.0f));
+    __m128 blended = _mm_add_ps(_mm_mul_ps(src, alpha), _mm_mul_ps(dst, _mm_sub_ps(_mm_set1_ps(1.0f), alpha)));
+    __m128i bytes = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(blended, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+    bytes = _mm_packs_epi32(bytes, bytes);
+    int bits = _mm_cvtsi128_si32(_mm_packus_epi16(bytes, bytes));
+    std::memcpy(out, &bits, sizeof(bits));
+}
+
+#else
+
+struct Color {
+    float c[4];
+};
+
+inline Color LoadTexel(const unsigned char* p)
+{
+    return { { float(p[0]), float(p[1]), float(p[2]), float(p[3]) } };
+}
+
+inline Color Lerp(Color a, Color b, float t)
+{
+    for (int i = 0; i < 4; i++) {
+        a.c[i] = a.c[i] + (b.c[i] - a.c[i]) * t;
+    }
+    return a;
+}
+
+inline Color ScaleRGB(Color c, float s)
+{
+    for (int i = 0; i < 3; i++) {
+        c.c[i] *= s;
+    }
+    return c;
+}
+
+inline Color ScaleRGBA(Color c, float s)
+{
+    for (int i = 0; i < 4; i++) {
+        c.c[i] *= s;
+    }
+    return c;
+}
+
+// GL_SRC_ALPHA / GL_ONE_MINUS_SRC_ALPHA 混合，定点帧缓冲先钳制源颜色
+inline void BlendPixel(unsigned char* out, Color color)
+{
+    float alpha = Saturate(color.c[3]);
+    for (int i = 0; i < 4; i++) {
+        float src = i < 3 ? Saturate(color.c[i]) : alpha;
+        float blended = src * alpha + (out[i] * (1.0f / 255.0f)) * (1.0f - alpha);
+        out[i] = static_cast<unsigned char>(blended * 255.0f + 0.5f);
+    }
+}
+
+#endif
+
+// 与 GL_LINEAR + GL_CLAMP_TO_EDGE 一致的双线性采样，uv 为 [0,1] 归一化坐标
+Color SampleBilinear(const RGBAImage& image, float u, float v)
+{
+    float x = u * image.width - 0.5f;
+    float y = v * image.height - 0.5f;
+    float fx = std::floor(x);
+    float fy = std::floor(y);
+    float tx = x - fx;
+    float ty = y - fy;
+
+    int x0 = std::min(std::max(int(fx), 0), image.width - 1);
+    int y0 = std::min(std::max(int(fy), 0), image.height - 1);
+    int x1 = std::min(std::max(int(fx) + 1, 0), image.width - 1);
+    int y1 = std::min(std::max(int(fy) + 1, 0), image.height - 1);
+
+    const size_t stride = size_t(image.width) * 4;
+    const unsigned char* row0 = image.pixels.data() + stride * y0;
+    const unsigned char* row1 = image.pixels.data() + stride * y1;
+
+    Color top = Lerp(LoadTexel(row0 + x0 * 4), LoadTexel(row0 + x1 * 4), tx);
+    Color bottom = Lerp(LoadTexel(row1 + x0 * 4), LoadTexel(row1 + x1 * 4), tx);
+    return ScaleRGBA(Lerp(top, bottom, ty), 1.0f / 255.0f);
+}
+
+// 运行期参数；exposure 与 scale 同为 1 时由 UnitGain 在编译期去掉相应的乘法
+template <bool UnitGain>
+struct DynamicRefraction {
+    static constexpr bool kUnitGain = UnitGain;
+    float refHeight;
+    float refLength;
+    float borderWidth;
+    float exposure;
+    float scale;
+
+    explicit DynamicRefraction(const GlassParams& params)
+        : refHeight(params.refHeight), refLength(params.refLength), borderWidth(params.borderWidth)
+        , exposure(params.exposure), scale(params.scale)
+    {
+    }
+};
+
+// 编译期常量参数（像素），常用预设的内层循环整体常量折叠
+template <int RefHeight, int RefLength, int BorderWidth>
+struct FixedRefraction {
+    static constexpr bool kUnitGain = true;
+    static constexpr float refHeight = float(RefHeight);
+    static constexpr float refLength = float(RefLength);
+    static constexpr float borderWidth = float(BorderWidth);
+    static constexpr float exposure = 1.0f;
+    static constexpr float scale = 1.0f;
+
+    static bool Matches(const GlassParams& params)
+    {
+        return params.refHeight == refHeight && params.refLength == refLength &&
+               params.borderWidth == borderWidth && params.exposure == exposure && params.scale == scale;
+    }
+
+    explicit FixedRefraction(const GlassParams&) {}
+};
+
+// 当前默认参数 20/30/5/1/1
+typedef FixedRefraction<20, 30, 5> DefaultRefraction;
+
+// 所有特化共用同一份逐像素代码，常量参数下与运行期参数的结果逐位一致
+template <class Refraction>
+void RenderRowsKernel(const RGBAImage& src, RGBAImage& dst, const GlassParams& params, int rowBegin, int rowEnd)
+{
+    if (params.width <= 0.0f || params.height <= 0.0f) return;
+
+    const Refraction refraction(params);
+    const float refHeight = refraction.refHeight;
+    const float refLength = refraction.refLength;
+    const float borderWidth = refraction.borderWidth;
+
+    const float halfWidth = params.width * 0.5f;
+    const int colBegin = std::max(0, int(std::floor(params.centerX - halfWidth)));
+    const int colEnd = std::min(src.width, int(std::ceil(params.centerX + halfWidth)) + 1);
+    const float invWidth = 1.0f / float(src.width);
+    const float invHeight = 1.0f / float(src.height);
+    const size_t stride = size_t(src.width) * 4;
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        unsigned char* row = dst.pixels.data() + stride * y;
+        float fragY = y + 0.5f;
+        float py = ((fragY - params.centerY) / params.height) * 2.0f;
+
+        for (int x = colBegin; x < colEnd; x++) {
+            float fragX = x + 0.5f;
+            float px = ((fragX - params.centerX) / params.width) * 2.0f;
+
+            // 网格之外（纹理坐标半径 > 0.5）不产生片元
+            float length = std::sqrt(px * px + py * py);
+            if (length > 1.0f) continue;
+
+            // sdf_generator.frag：半径 0.5 的圆形距离场
+            float normalizedDist = (length - 0.5f) / 0.5f;
+            normalizedDist = std::min(std::max(normalizedDist, -1.0f), 1.0f);
+            float distance = (normalizedDist + 1.0f) * 0.5f;
+            if (distance >= 0.99999f) continue;
+
+            float nx = 0.0f, ny = 0.0f;
+            if (length > 1e-6f) {
+                nx = px / length;
+                ny = py / length;
+            }
+
+            // liquid_glass.frag
+            float dis = (1.0f - distance) * 50.0f;
+            if (!Refraction::kUnitGain) dis *= refraction.scale;
+            Color result;
+            if (dis < refHeight) {
+                float ratio = (dis - refHeight) / (0.0f - refHeight);
+                float offsetVal = refHeight + ratio * (-refLength);
+                float offset = dis - offsetVal;
+
+                result = SampleBilinear(src, Saturate((fragX + nx * offset) * invWidth),
+                                        Saturate((fragY + ny * offset) * invHeight));
+                if (!Refraction::kUnitGain) result = ScaleRGB(result, refraction.exposure);
+
+                if (dis <= borderWidth) {
+                    float edgeRatio = 1.0f - (dis / borderWidth);
+                    float t = Saturate(edgeRatio);
+                    float smoothRatio = t * t * (3.0f - 2.0f * t);
+                    float angleFactor = std::fabs(nx * ny);
+                    float highlight = smoothRatio * (0.3f + angleFactor * 0.7f);
+                    result = ScaleRGBA(result, 1.0f + highlight * 0.6f);
+                }
+            } else {
+                result = SampleBilinear(src, fragX * invWidth, fragY * invHeight);
+                if (!Refraction::kUnitGain) result = ScaleRGB(result, refraction.exposure);
+            }
+
+            BlendPixel(row + x * 4, result);
+        }
+    }
+}
+
+}
+
+void GlassReferenceRenderer::GetRowRange(const GlassParams& params, int imageHeight, int& rowBegin, int& rowEnd)
+{
+    float halfHeight = params.height * 0.5f;
+    rowBegin = std::max(0, int(std::floor(params.centerY - halfHeight)));
+    rowEnd = std::min(imageHeight, int(std::ceil(params.centerY + halfHeight)) + 1);
+    if (rowEnd < rowBegin) rowEnd = rowBegin;
+}
+
+GlassReferenceRenderer::RowKernel GlassReferenceRenderer::SelectKernel(const GlassParams& params)
+{
+    if (DefaultRefraction::Matches(params)) {
+        return &RenderRowsKernel<DefaultRefraction>;
+    }
+    if (params.exposure == 1.0f && params.scale == 1.0f) {
+        return &RenderRowsKernel<DynamicRefraction<true>>;
+    }
+    return &RenderRowsKernel<DynamicRefraction<false>>;
+}
+
+void GlassReferenceRenderer::RenderRows(const RGBAImage& src, RGBAImage& dst, const GlassParams& params,
+                                        int rowBegin, int rowEnd)
+{
+    SelectKernel(params)(src, dst, params, rowBegin, rowEnd);
+}
+
+void GlassReferenceRenderer::Render(const RGBAImage& src, RGBAImage& dst, const GlassParams& params)
+{
+    dst = src;
+    int rowBegin, rowEnd;
+    GetRowRange(params, src.height, rowBegin, rowEnd);
+    RenderRows(src, dst, params, rowBegin, rowEnd);
+}
@@ -0,0 +1,149 @@
+#include "GlassTileBinner.h"
+#include <algorithm>
+#include <cmath>
+
+GlassTileBinner::GlassTileBinner()
+    : m_screenWidth(0), m_screenHeight(0), m_tilesX(0), m_tilesY(0)
+    , m_maxTileInstances(0), m_coveredTiles(0)
+{
+}
+
+bool GlassTileBinner::ToTileSpan(float minX, float minY, float maxX, float maxY, TileSpan& span) const
+{
+    if (maxX <= 0.0f || maxY <= 0.0f || minX >= float(m_screenWidth) || minY >= float(m_screenHeight) ||
+        !(minX < maxX) || !(minY < maxY)) {
+        return false;
+    }
+    // 先裁剪到屏幕再取整，避免超大坐标转换为 int 时溢出
+    minX = std::max(minX, 0.0f);
+    minY = std::max(minY, 0.0f);
+    maxX = std::min(maxX, float(m_screenWidth));
+    maxY = std::min(maxY, float(m_screenHeight));
+    span.x0 = int(minX) / kTileSize;
+    span.y0 = int(minY) / kTileSize;
+    span.x1 = std::min(m_tilesX - 1, (int(std::ceil(maxX)) - 1) / kTileSize);
+    span.y1 = std::min(m_tilesY - 1, (int(std::ceil(maxY)) - 1) / kTileSize);
+    return true;
+}
+
+void GlassTileBinner::Bin(int screenWidth, int screenHeight, const GlassTileBounds* instances, size_t count)
+{
+    if (screenWidth != m_screenWidth || screenHeight != m_screenHeight) {
+        m_screenWidth = screenWidth;
+        m_screenHeight = screenHeight;
+        m_tilesX = (screenWidth + kTileSize - 1) / kTileSize;
+        m_tilesY = (screenHeight + kTileSize - 1) / kTileSize;
+    }
+    const size_t tileCount = size_t(m_tilesX) * m_tilesY;
+    m_tileRanges.assign(tileCount * 2, 0);
+    m_captureMask.assign(tileCount, 0);
+    m_spans.resize(count);
+
+    // 第一趟：计数，顺便标记捕获 tile
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        const GlassTileBounds& bounds = instances[i];
+        TileSpan& span = m_spans[i];
+        if (!ToTileSpan(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY, span)) {
+            span.x0 = 0;
+            span.x1 = -1;
+            span.y0 = 0;
+            span.y1 = -1;
+            continue;
+        }
+        for (int y = span.y0; y <= span.y1; y++) {
+            for (int x = span.x0; x <= span.x1; x++) {
+                m_tileRanges[(size_t(y) * m_tilesX + x) * 2 + 1]++;
+            }
+        }
+        total += size_t(span.x1 - span.x0 + 1) * (span.y1 - span.y0 + 1);
+
+        TileSpan capture;
+        if (ToTileSpan(bounds.minX - bounds.margin, bounds.minY - bounds.margin,
+                       bounds.maxX + bounds.margin, bounds.maxY + bounds.margin, capture)) {
+            for (int y = capture.y0; y <= capture.y1; y++) {
+                std::fill(m_captureMask.begin() + size_t(y) * m_tilesX + capture.x0,
+                          m_captureMask.begin() + size_t(y) * m_tilesX + capture.x1 + 1, uint8_t(1));
+            }
+        }
+    }
+
+    // 第二趟：前缀和得到各 tile 的偏移
+    m_shadeMask.resize(tileCount);
+    m_cursors.resize(tileCount);
+    m_maxTileInstances = 0;
+    m_coveredTiles = 0;
+    uint32_t offset = 0;
+    for (size_t t = 0; t < tileCount; t++) {
+        uint32_t tileInstances = m_tileRanges[t * 2 + 1];
+        m_tileRanges[t * 2] = offset;
+        m_cursors[t] = offset;
+        m_shadeMask[t] = tileInstances > 0;
+        m_maxTileInstances = std::max(m_maxTileInstances, tileInstances);
+        m_coveredTiles += tileInstances > 0;
+        offset += tileInstances;
+    }
+
+    // 第三趟：按实例顺序填充，tile 内的顺序即绘制顺序
+    m_tileInstances.resize(total);
+    for (size_t i = 0; i < count; i++) {
+        const TileSpan& span = m_spans[i];
+        for (int y = span.y0; y <= span.y1; y++) {
+            for (int x = span.x0; x <= span.x1; x++) {
+                m_tileInstances[m_cursors[size_t(y) * m_tilesX + x]++] = uint32_t(i);
+            }
+        }
+    }
+
+    BuildRects(m_shadeMask, m_shadeRects);
+    BuildRects(m_captureMask, m_captureRects);
+}
+
+void GlassTileBinner::BuildRects(const std::vector<uint8_t>& mask, std::vector<GlassTileRect>& rects)
+{
+    // 先在 tile 坐标下把每行的连续段与上一行完全对齐的段合并，最后换算为像素并裁剪到屏幕
+    rects.clear();
+    size_t openStart = 0;
+    for (int y = 0; y < m_tilesY; y++) {
+        size_t currentRow = rects.size();
+        const uint8_t* row = mask.data() + size_t(y) * m_tilesX;
+        for (int x = 0; x < m_tilesX; ) {
+            if (!row[x]) {
+                x++;
+                continue;
+            }
+            int start = x;
+            while (x < m_tilesX && row[x]) x++;
+
+            bool merged = false;
+            for (size_t r = openStart; r < currentRow; r++) {
+                GlassTileRect& rect = rects[r];
+                if (rect.x == start && rect.width == x - start && rect.y + rect.height == y) {
+                    rect.height++;
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) {
+                GlassTileRect rect = { start, y, x - start, 1 };
+                rects.push_back(rect);
+            }
+        }
+        // 没有延伸到本行的矩形移到前面，不再参与之后的合并
+        size_t closed = openStart;
+        for (size_t r = openStart; r < rects.size(); r++) {
+            if (rects[r].y + rects[r].height != y + 1) {
+                std::swap(rects[closed++], rects[r]);
+            }
+        }
+        openStart = closed;
+    }
+
+    for (GlassTileRect& rect : rects) {
+        int x0 = rect.x * kTileSize;
+        int y0 = rect.y * kTileSize;
+        int x1 = std::min((rect.x + rect.width) * kTileSize, m_screenWidth);
+        int y1 = std::min((rect.y + rect.height) * kTileSize, m_screenHeight);
+        rect = { x0, y0, x1 - x0, y1 - y0 };
+    }
+}
@@ -0,0 +1,342 @@
+#include "ImageWriter.h"
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+// 固定哈夫曼编码的 deflate 压缩器，单探针哈希匹配，速度优先
+class DeflateWriter {
+public:
+    explicit DeflateWriter(std::vector<unsigned char>& out) : m_out(out), m_bitBuffer(0), m_bitCount(0) {}
+
+    void PutBits(uint32_t value, int count)
+    {
+        m_bitBuffer |= value << m_bitCount;
+        m_bitCount += count;
+        while (m_bitCount >= 8) {
+            m_out.push_back(static_cast<unsigned char>(m_bitBuffer & 0xff));
+            m_bitBuffer >>= 8;
+            m_bitCount -= 8;
+        }
+    }
+
+    void PutHuffman(uint32_t code, int length)
+    {
+        // 哈夫曼码按高位在前写入，需要翻转
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        PutBits(reversed, length);
+    }
+
+    void PutLiteral(int value)
+    {
+        if (value < 144)      PutHuffman(0x30 + value, 8);
+        else if (value < 256) PutHuffman(0x190 + value - 144, 9);
+        else if (value < 280) PutHuffman(value - 256, 7);
+        else                  PutHuffman(0xc0 + value - 280, 8);
+    }
+
+    void PutMatch(int length, int distance)
+    {
+        static const int lengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                          35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const int lengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                           3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const int distBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                        8193, 12289, 16385, 24577 };
+        static const int distExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                         7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        int l = 0;
+        while (l < 28 && lengthBase[l + 1] <= length) l++;
+        PutLiteral(257 + l);
+        if (lengthExtra[l]) PutBits(length - lengthBase[l], lengthExtra[l]);
+
+        int d = 0;
+        while (d < 29 && distBase[d + 1] <= distance) d++;
+        PutHuffman(d, 5);
+        if (distExtra[d]) PutBits(distance - distBase[d], distExtra[d]);
+    }
+
+    // 以空存储块结束当前段并对齐到字节边界，下一段可以从这里独立开始解压
+    void SyncFlush()
+    {
+        PutBits(0, 1);
+        PutBits(0, 2);
+        Flush();
+        m_out.push_back(0x00);
+        m_out.push_back(0x00);
+        m_out.push_back(0xff);
+        m_out.push_back(0xff);
+    }
+
+    void Flush()
+    {
+        if (m_bitCount > 0) {
+            m_out.push_back(static_cast<unsigned char>(m_bitBuffer & 0xff));
+        }
+        m_bitBuffer = 0;
+        m_bitCount = 0;
+    }
+
+private:
+    std::vector<unsigned char>& m_out;
+    uint32_t m_bitBuffer;
+    int m_bitCount;
+};
+
+// segmentStarts 非空时在这些偏移处分段：匹配不跨段，段间以同步刷新隔开，
+// segmentOffsets 返回各段在 zlib 流中的起始字节（第一段为 0，含 zlib 头）
+void ZlibCompress(const unsigned char* data, size_t size, std::vector<unsigned char>& out,
+                  const std::vector<size_t>& segmentStarts, std::vector<uint32_t>& segmentOffsets)
+{
+    const int hashBits = 15;
+    const size_t windowSize = 32768;
+    const int maxMatch = 258;
+
+    const size_t streamStart = out.size();
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    DeflateWriter writer(out);
+    std::vector<int64_t> head(size_t(1) << hashBits, -1);
+    const size_t segmentCount = std::max(size_t(1), segmentStarts.size());
+    segmentOffsets.clear();
+
+    for (size_t s = 0; s < segmentCount; s++) {
+        const size_t begin = segmentStarts.empty() ? 0 : segmentStarts[s];
+        const size_t end = s + 1 < segmentCount ? segmentStarts[s + 1] : size;
+        const bool last = s + 1 == segmentCount;
+        segmentOffsets.push_back(s == 0 ? 0 : uint32_t(out.size() - streamStart));
+
+        writer.PutBits(last ? 1 : 0, 1);    // BFINAL
+        writer.PutBits(1, 2);               // 固定哈夫曼
+
+        size_t i = begin;
+        while (i < end) {
+            int bestLength = 0;
+            size_t bestDistance = 0;
+            if (i + 3 <= end) {
+                uint32_t h = (uint32_t(data[i]) << 16 | uint32_t(data[i + 1]) << 8 | data[i + 2]) * 2654435761u;
+                h >>= (32 - hashBits);
+                int64_t candidate = head[h];
+                head[h] = int64_t(i);
+                if (candidate >= int64_t(begin) && i - size_t(candidate) <= windowSize) {
+                    size_t limit = std::min(end - i, size_t(maxMatch));
+                    size_t length = 0;
+                    while (length < limit && data[size_t(candidate) + length] == data[i + length]) length++;
+                    if (length >= 3) {
+                        bestLength = int(length);
+                        bestDistance = i - size_t(candidate);
+                    }
+                }
+            }
+
+            if (bestLength >= 3) {
+                writer.PutMatch(bestLength, int(bestDistance));
+                i += bestLength;
+            } else {
+                writer.PutLiteral(data[i]);
+                i++;
+            }
+        }
+        writer.PutLiteral(256);
+        if (last) {
+            writer.Flush();
+        } else {
+            writer.SyncFlush();
+        }
+    }
+
+    uint32_t a = 1, b = 0;
+    for (size_t n = 0; n < size; ) {
+        size_t block = std::min(size - n, size_t(5552));
+        for (size_t k = 0; k < block; k++, n++) {
+            a += data[n];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    out.push_back(static_cast<unsigned char>(adler >> 24));
+    out.push_back(static_cast<unsigned char>(adler >> 16));
+    out.push_back(static_cast<unsigned char>(adler >> 8));
+    out.push_back(static_cast<unsigned char>(adler));
+}
+
+uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+{
+    struct Table {
+        uint32_t entries[256];
+        Table()
+        {
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                }
+                entries[n] = c;
+            }
+        }
+    };
+    // 多个编码线程并发调用，依赖局部静态变量的线程安全初始化
+    static const Table table;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void PutU32(std::vector<unsigned char>& out, uint32_t v)
+{
+    out.push_back(static_cast<unsigned char>(v >> 24));
+    out.push_back(static_cast<unsigned char>(v >> 16));
+    out.push_back(static_cast<unsigned char>(v >> 8));
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+void PutChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t size)
+{
+    PutU32(out, uint32_t(size));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size) out.insert(out.end(), data, data + size);
+    PutU32(out, Crc32(out.data() + start, size + 4));
+}
+
+int Paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+}
+
+bool ImageWriter::encodePNG(int width, int height, int channels, const unsigned char* pixels,
+                            bool flipVertically, std::vector<unsigned char>& out, int segmentRows)
+{
+    if (width <= 0 || height <= 0 || !pixels || (channels != 3 && channels != 4)) {
+        std::cerr << "ImageWriter: Invalid image for PNG encoding" << std::endl;
+        return false;
+    }
+
+    const size_t stride = size_t(width) * channels;
+    std::vector<unsigned char> filtered((stride + 1) * height);
+    std::vector<unsigned char> candidate(stride);
+    std::vector<size_t> segmentStarts;
+
+    // 每行尝试 5 种滤波器，选择残差绝对值之和最小的一种
+    for (int y = 0; y < height; y++) {
+        int srcRow = flipVertically ? height - 1 - y : y;
+        const unsigned char* row = pixels + stride * srcRow;
+        const unsigned char* prev = nullptr;
+        // 段首行只能用 None/Sub，使各段不依赖上一段的像素
+        bool segmentStart = segmentRows > 0 && y % segmentRows == 0;
+        if (segmentStart) {
+            segmentStarts.push_back((stride + 1) * y);
+        }
+        if (y > 0 && !segmentStart) {
+            int prevRow = flipVertically ? srcRow + 1 : srcRow - 1;
+            prev = pixels + stride * prevRow;
+        }
+
+        unsigned char* dst = filtered.data() + (stride + 1) * y;
+        long bestScore = -1;
+        for (int filter = 0; filter < (segmentStart ? 2 : 5); filter++) {
+            long score = 0;
+            for (size_t x = 0; x < stride; x++) {
+                int a = x >= size_t(channels) ? row[x - channels] : 0;
+                int b = prev ? prev[x] : 0;
+                int c = (prev && x >= size_t(channels)) ? prev[x - channels] : 0;
+                int predicted = 0;
+                switch (filter) {
+                case 1: predicted = a; break;
+                case 2: predicted = b; break;
+                case 3: predicted = (a + b) >> 1; break;
+                case 4: predicted = Paeth(a, b, c); break;
+                default: break;
+                }
+                unsigned char v = static_cast<unsigned char>(row[x] - predicted);
+                candidate[x] = v;
+                score += std::abs(int(static_cast<signed char>(v)));
+            }
+            if (bestScore < 0 || score < bestScore) {
+                bestScore = score;
+                dst[0] = static_cast<unsigned char>(filter);
+                std::memcpy(dst + 1, candidate.data(), stride);
+            }
+        }
+    }
+
+    if (segmentStarts.size() < 2) {
+        segmentStarts.clear();
+    }
+    std::vector<unsigned char> compressed;
+    std::vector<uint32_t> segmentOffsets;
+    compressed.reserve(filtered.size() / 2);
+    ZlibCompress(filtered.data(), filtered.size(), compressed, segmentStarts, segmentOffsets);
+
+    static const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    unsigned char header[13];
+    header[0] = static_cast<unsigned char>(width >> 24);
+    header[1] = static_cast<unsigned char>(width >> 16);
+    header[2] = static_cast<unsigned char>(width >> 8);
+    header[3] = static_cast<unsigned char>(width);
+    header[4] = static_cast<unsigned char>(height >> 24);
+    header[5] = static_cast<unsigned char>(height >> 16);
+    header[6] = static_cast<unsigned char>(height >> 8);
+    header[7] = static_cast<unsigned char>(height);
+    header[8] = 8;
+    header[9] = channels == 4 ? 6 : 2;
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+
+    out.clear();
+    out.reserve(compressed.size() + 64);
+    out.insert(out.end(), signature, signature + sizeof(signature));
+    PutChunk(out, "IHDR", header, sizeof(header));
+    if (!segmentStarts.empty()) {
+        // lgIX：私有辅助块，段数后跟每段的 (首行, zlib 流内偏移)，供 PNGDecoder 并行解码
+        std::vector<unsigned char> index;
+        PutU32(index, uint32_t(segmentStarts.size()));
+        for (size_t s = 0; s < segmentStarts.size(); s++) {
+            PutU32(index, uint32_t(segmentStarts[s] / (stride + 1)));
+            PutU32(index, segmentOffsets[s]);
+        }
+        PutChunk(out, "lgIX", index.data(), index.size());
+    }
+    PutChunk(out, "IDAT", compressed.data(), compressed.size());
+    PutChunk(out, "IEND", nullptr, 0);
+    return true;
+}
+
+bool ImageWriter::writePNG(const std::string& path, int width, int height, int channels,
+                           const unsigned char* pixels, bool flipVertically, int segmentRows)
+{
+    std::vector<unsigned char> png;
+    if (!encodePNG(width, height, channels, pixels, flipVertically, png, segmentRows)) {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "ImageWriter: Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(png.data()), png.size());
+    return bool(file);
+}
@@ -0,0 +1,250 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+struct JobSystem::Job {
+    Task task;
+    JobCounter* counter;
+    Job* next;
+};
+
+namespace {
+
+// 找不到作业后在睡眠前再尝试的次数，细粒度作业接连提交时省去一次唤醒
+const int kSpinCount = 64;
+
+thread_local const JobSystem* t_system = nullptr;
+thread_local int t_workerIndex = -1;
+// 非工作线程窃取时的起点，分散到不同的队列上
+thread_local unsigned int t_victim = 0;
+
+}
+
+JobSystem::JobSystem(int workerCount)
+    : m_injectedCount(0), m_epoch(0), m_sleepers(0), m_stopping(false), m_stealCount(0)
+{
+    if (workerCount < 0) {
+        workerCount = std::max(0, int(std::thread::hardware_concurrency()) - 1);
+    }
+    for (int i = 0; i < workerCount; i++) {
+        m_deques.emplace_back(new Deque());
+    }
+    for (int i = 0; i < workerCount; i++) {
+        m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    m_stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+
+    // 没有人等待的作业直接丢弃
+    Job* job;
+    for (std::unique_ptr<Deque>& deque : m_deques) {
+        while (deque->TryPop(job)) delete job;
+    }
+    for (Job* injected : m_injected) {
+        delete injected;
+    }
+}
+
+JobSystem& JobSystem::Shared()
+{
+    static JobSystem system;
+    return system;
+}
+
+int JobSystem::CurrentWorkerIndex() const
+{
+    return t_system == this ? t_workerIndex : -1;
+}
+
+void JobSystem::Run(const Task& task, JobCounter* counter)
+{
+    if (counter) {
+        counter->m_pending.fetch_add(1);
+    }
+    Schedule(new Job{ task, counter, nullptr });
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, const Task& task, JobCounter* counter)
+{
+    if (counter) {
+        counter->m_pending.fetch_add(1);
+    }
+    Job* job = new Job{ task, counter, nullptr };
+    Job* head = dependency.m_continuations.load();
+    do {
+        job->next = head;
+    } while (!dependency.m_continuations.compare_exchange_weak(head, job));
+
+    // 依赖可能在压栈之前已经归零；与 Complete 各自先写后读，至少有一方会取走这个作业
+    if (dependency.m_pending.load() == 0) {
+        ReleaseContinuations(dependency);
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    const int index = CurrentWorkerIndex();
+    while (!counter.IsDone()) {
+        Job* job = FindJob(index);
+        if (job) {
+            Execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(size_t begin, size_t end, const RangeTask& body, size_t minGrain)
+{
+    if (begin >= end) return;
+
+    const size_t count = end - begin;
+    const size_t chunks = size_t(GetWorkerCount() + 1) * kChunksPerThread;
+    const size_t grain = std::max(std::max<size_t>(minGrain, 1), (count + chunks - 1) / chunks);
+    if (count <= grain) {
+        body(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    SplitRange(begin, end, grain, body, counter);
+    Wait(counter);
+}
+
+void JobSystem::SplitRange(size_t begin, size_t end, size_t grain, const RangeTask& body, JobCounter& counter)
+{
+    // body 与 counter 在 ParallelFor 的栈上，它等待全部块完成后才返回
+    while (end - begin > grain) {
+        size_t middle = begin + (end - begin) / 2;
+        Run([this, middle, end, grain, &body, &counter]() {
+            SplitRange(middle, end, grain, body, counter);
+        }, &counter);
+        end = middle;
+    }
+    body(begin, end);
+}
+
+void JobSystem::Schedule(Job* job)
+{
+    const int index = CurrentWorkerIndex();
+    if (index < 0 || !m_deques[index]->TryPush(job)) {
+        std::lock_guard<std::mutex> lock(m_injectedMutex);
+        m_injected.push_back(job);
+        m_injectedCount++;
+    }
+    Wake();
+}
+
+JobSystem::Job* JobSystem::FindJob(int index)
+{
+    Job* job = nullptr;
+    if (index >= 0 && m_deques[index]->TryPop(job)) {
+        return job;
+    }
+
+    if (m_injectedCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_injectedMutex);
+        if (!m_injected.empty()) {
+            job = m_injected.front();
+            m_injected.pop_front();
+            m_injectedCount--;
+            m_stealCount.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    const size_t count = m_deques.size();
+    const size_t start = index >= 0 ? size_t(index) + 1 : size_t(t_victim++);
+    for (size_t i = 0; i < count; i++) {
+        size_t victim = (start + i) % count;
+        if (int(victim) == index || m_deques[victim]->IsEmpty()) continue;
+        if (m_deques[victim]->TrySteal(job)) {
+            m_stealCount.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    job->task();
+    JobCounter* counter = job->counter;
+    delete job;
+    if (counter) {
+        Complete(*counter);
+    }
+}
+
+void JobSystem::Complete(JobCounter& counter)
+{
+    counter.m_releasing.fetch_add(1);
+    if (counter.m_pending.fetch_sub(1) == 1) {
+        ReleaseContinuations(counter);
+    }
+    // 这是对 counter 的最后一次访问，之后等待者可以销毁它
+    counter.m_releasing.fetch_sub(1);
+}
+
+void JobSystem::ReleaseContinuations(JobCounter& counter)
+{
+    Job* job = counter.m_continuations.exchange(nullptr);
+    while (job) {
+        Job* next = job->next;
+        job->next = nullptr;
+        Schedule(job);
+        job = next;
+    }
+}
+
+void JobSystem::Wake()
+{
+    m_epoch.fetch_add(1);
+    if (m_sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wake.notify_one();
+    }
+}
+
+void JobSystem::WorkerLoop(int index)
+{
+    t_system = this;
+    t_workerIndex = index;
+
+    while (!m_stopping) {
+        Job* job = FindJob(index);
+        for (int spin = 0; !job && spin < kSpinCount; spin++) {
+            std::this_thread::yield();
+            job = FindJob(index);
+        }
+        if (job) {
+            Execute(job);
+            continue;
+        }
+
+        // 先记下 epoch 再找一次：此后提交的作业一定会改变 epoch，不会在睡眠中错过
+        unsigned int epoch = m_epoch.load();
+        job = FindJob(index);
+        if (job) {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepers++;
+        m_wake.wait(lock, [this, epoch]() { return m_stopping || m_epoch.load() != epoch; });
+        m_sleepers--;
+    }
+
+    t_system = nullptr;
+    t_workerIndex = -1;
+}
@@ -10,11 +10,16 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
+#include <algorithm>
 
-extern float g_ref_height;
-extern float g_ref_length;
-
-LiquidGlass::LiquidGlass() : m_distortion(3.0f)
+LiquidGlass::LiquidGlass() : m_meshCache(nullptr), m_mesh(nullptr)
+    , m_meshKey{ GlassMeshShape::Disc, 32 }, m_sdfDefinesShape(false)
+    , m_captureDirty(true), m_refHeight(20.0f), m_refLength(30.0f)
+    , m_distortion(3.0f), m_dispersion(GlassDispersion::Off), m_dispersionStrength(0.15f)
+    , m_backgroundCapture(nullptr), m_sdfGenerator(nullptr), m_backgroundRenderer(nullptr)
+    , m_cacheTexture(0), m_cacheCapacityWidth(0), m_cacheCapacityHeight(0)
+    , m_cacheRect{ 0, 0, 0, 0 }, m_cacheKey(), m_cacheValid(false)
+    , m_cacheHits(0), m_cacheMisses(0)
 {
     m_material.color = glm::vec3(0.98f, 0.99f, 1.0f);
     m_material.transparency = 0.98f;
@@ -29,105 +34,85 @@ LiquidGlass::~LiquidGlass()
 
 void LiquidGlass::Cleanup()
 {
-    glDeleteVertexArrays(1, &m_VAO);
-    glDeleteBuffers(1, &m_VBO);
-    glDeleteBuffers(1, &m_EBO);
+    if (m_mesh && m_meshCache) {
+        m_meshCache->Release(m_meshKey);
+    }
+    m_mesh = nullptr;
+    if (m_cacheTexture) {
+        glDeleteTextures(1, &m_cacheTexture);
+        m_cacheTexture = 0;
+    }
+    m_cacheCapacityWidth = 0;
+    m_cacheCapacityHeight = 0;
+    m_cacheValid = false;
 }
 
 void LiquidGlass::Initialize()
 {
-    CreatePlane();
-    SetupBuffers();
     LoadShaders();
 }
 
-void LiquidGlass::CreatePlane()
+void LiquidGlass::InitializeShared(const LiquidGlass& primary)
 {
-    m_vertices.clear();
-    m_indices.clear();
-
-    float radius = 0.5f;
-    int segments = 32;
-    
-    m_vertices.push_back(0.0f);
-    m_vertices.push_back(0.0f);
-    m_vertices.push_back(0.0f);
-    m_vertices.push_back(0.0f);
-    m_vertices.push_back(0.0f);
-    m_vertices.push_back(1.0f);
-    m_vertices.push_back(0.5f);
-    m_vertices.push_back(0.5f);
-    
-    for (int i = 0; i <= segments; i++) {
-        float angle = 2.0f * 3.1415926f * float(i) / float(segments);
-        float x = cos(angle) * radius;
-        float y = sin(angle) * radius;
-        
-        m_vertices.push_back(x);
-        m_vertices.push_back(y);
-        m_vertices.push_back(0.0f);
-        m_vertices.push_back(0.0f);
-        m_vertices.push_back(0.0f);
-        m_vertices.push_back(1.0f);
-        m_vertices.push_back(x + 0.5f);
-        m_vertices.push_back(y + 0.5f);
-    }
-    
-    for (int i = 0; i < segments; i++) {
-        m_indices.push_back(0);
-        m_indices.push_back(i + 1);
-        m_indices.push_back(i + 2);
-    }
-    
-    m_vertexCount = segments + 2;
-    m_indexCount = segments * 3;
+    m_shaderProgram = primary.m_shaderProgram;
 }
 
-void LiquidGlass::SetupBuffers()
+glm::mat4 LiquidGlass::GetModelMatrix() const
 {
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_EBO);
-
-    glBindVertexArray(m_VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(float), &m_vertices[0], GL_STATIC_DRAW);
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(m_glassPosition.x, m_glassPosition.y, 0.0f));
+    return glm::scale(model, glm::vec3(m_glassSize.x, m_glassSize.y, 1.0f));
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int), &m_indices[0], GL_STATIC_DRAW);
+void LiquidGlass::SelectMesh(const glm::mat4& mvp, bool hasSDF)
+{
+    if (!m_meshCache) return;
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    GlassMeshKey key;
+    if (m_sdfDefinesShape && hasSDF) {
+        key = { GlassMeshShape::BoundingQuad, 4 };
+    } else {
+        float radius = GlassMeshCache::ProjectedRadius(mvp, m_screenWidth, m_screenHeight);
+        key = { GlassMeshShape::Disc, GlassMeshCache::SegmentsForRadius(radius) };
+    }
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    if (m_mesh && key == m_meshKey) return;
 
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    const GlassMesh* mesh = m_meshCache->Acquire(key);
+    if (!mesh) return;
 
-    glBindVertexArray(0);
+    if (m_mesh) {
+        m_meshCache->Release(m_meshKey);
+    }
+    m_mesh = mesh;
+    m_meshKey = key;
 }
 
 void LiquidGlass::LoadShaders()
 {
-    Shader glassShader("shaders/liquid_glass.vert", "shaders/liquid_glass.frag");
+    // decodeSDFData 按生成器的存储格式特化
+    SDFFormat format = m_sdfGenerator ? m_sdfGenerator->GetFormat() : SDFFormat::RGBA8;
+    Shader glassShader("shaders/liquid_glass.vert", "shaders/liquid_glass.frag", SDFGenerator::GetShaderDefines(format));
     m_shaderProgram = glassShader.ID;
 }
 
 void LiquidGlass::Update(float deltaTime)
 {
-    UpdateBackgroundCapture();
+    if (m_captureDirty) {
+        UpdateBackgroundCapture();
+    }
 }
 
 void LiquidGlass::UpdateBackgroundCapture()
 {
     if (m_backgroundCapture) {
-        m_backgroundCapture->UpdateCaptureRegion(m_glassPosition, m_glassSize);
+        glm::vec2 captureSize = glm::vec2(m_glassSize.x, m_glassSize.x);
+        m_backgroundCapture->UpdateCaptureRegion(m_glassPosition, captureSize);
     }
+    m_captureDirty = false;
 }
 
-void LiquidGlass::Render(const glm::mat4& projection, const glm::mat4& view)
+void LiquidGlass::AddPasses(RenderGraph& graph, RenderResource target, const glm::mat4& projection, const glm::mat4& view)
 {
     if (!m_shaderProgram || !m_backgroundRenderer) return;
 
@@ -138,26 +123,137 @@ void LiquidGlass::Render(const glm::mat4& projection, const glm::mat4& view)
         return;
     }
     
-    GLuint backgroundCaptureTexture = backgroundTexture;
-    
-    if (m_backgroundCapture) {
-        glm::vec2 glassCenter = m_glassPosition;
-        glm::vec2 captureSize = glm::vec2(m_glassSize.x, m_glassSize.x);
-        
-        m_backgroundCapture->UpdateCaptureRegion(glassCenter, captureSize);
-        
-        m_backgroundCapture->BeginCapture();
-        m_backgroundCapture->EndCapture();
-        backgroundCaptureTexture = m_backgroundCapture->GetCaptureTexture();
+    // 玻璃、相机、背景都与上次写入缓存时相同，区域内的合成结果也必然相同，直接拷回
+    const RenderTextureDesc& targetDesc = graph.GetDesc(target);
+    ResultCacheKey key = { projection * view * GetModelMatrix(), m_refHeight, m_refLength, backgroundTexture,
+                           m_backgroundRenderer->GetContentVersion(), targetDesc.width, targetDesc.height,
+                           m_dispersion, m_dispersionStrength };
+    if (m_cacheValid && key == m_cacheKey) {
+        m_cacheHits++;
+        AddCachePass(graph, target, false);
+        return;
     }
-    
-    GLuint sdfTexture = 0;
-    if (m_sdfGenerator && m_backgroundCapture) {
-        m_sdfGenerator->SetSize(m_backgroundCapture->GetCaptureWidth(), m_backgroundCapture->GetCaptureHeight());
-        m_sdfGenerator->GenerateFromTexture(backgroundCaptureTexture, 0.5f);
-        sdfTexture = m_sdfGenerator->GetSDFTexture();
+    m_cacheMisses++;
+    // 连续两帧不变才写入缓存，玻璃持续移动时不付出额外拷贝
+    bool stable = key == m_cacheKey;
+    m_cacheKey = key;
+    m_cacheValid = false;
+
+    RenderResource background = graph.ImportTexture("Background", backgroundTexture);
+
+    // 捕获尺寸跟随捕获区域，SDF 尺寸跟随玻璃在屏幕上的大小；SDF 不读取捕获结果时拷贝 pass 由渲染图剔除
+    RenderResource sdf = kInvalidRenderResource;
+    if (m_backgroundCapture && m_sdfGenerator) {
+        if (m_captureDirty) {
+            UpdateBackgroundCapture();
+        }
+        float radius = GlassMeshCache::ProjectedRadius(projection * view * GetModelMatrix(), m_screenWidth, m_screenHeight);
+        RenderResource capture = m_backgroundCapture->AddPass(graph, target);
+        sdf = m_sdfGenerator->AddPass(graph, capture, SDFGenerator::ResolutionForFootprint(radius * 2.0f), 0.5f);
+    }
+
+    LiquidGlass* glass = this;
+    graph.AddPass(GetPassName(m_dispersion), [=](const RenderPassContext& context) {
+        context.BindTarget();
+        glass->Draw(context.GetTexture(background),
+                    sdf != kInvalidRenderResource ? context.GetTexture(sdf) : 0, projection, view);
+    }).Read(background).Read(sdf).Write(target);
+
+    if (stable && ProjectScreenRect(key.mvp, targetDesc.width, targetDesc.height, m_cacheRect)) {
+        AddCachePass(graph, target, true);
+        m_cacheValid = true;
+    }
+}
+
+bool LiquidGlass::ResultCacheKey::operator==(const ResultCacheKey& other) const
+{
+    return mvp == other.mvp && refHeight == other.refHeight && refLength == other.refLength &&
+           backgroundTexture == other.backgroundTexture && backgroundVersion == other.backgroundVersion &&
+           targetWidth == other.targetWidth && targetHeight == other.targetHeight &&
+           dispersion == other.dispersion && dispersionStrength == other.dispersionStrength;
+}
+
+const char* LiquidGlass::GetPassName(GlassDispersion mode)
+{
+    switch (mode) {
+    case GlassDispersion::Capped: return "LiquidGlass+Dispersion";
+    case GlassDispersion::Full:   return "LiquidGlass+DispersionFull";
+    default:                      return "LiquidGlass";
+    }
+}
+
+bool LiquidGlass::GetScreenRect(const glm::mat4& projection, const glm::mat4& view, int targetWidth, int targetHeight,
+                                ScreenRect& rect) const
+{
+    return ProjectScreenRect(projection * view * GetModelMatrix(), targetWidth, targetHeight, rect);
+}
+
+bool LiquidGlass::ProjectScreenRect(const glm::mat4& mvp, int targetWidth, int targetHeight, ScreenRect& rect)
+{
+    // 网格（圆盘或包围四边形）都在单位四边形 [-0.5, 0.5] 内，投影四角取包围盒，外扩一个像素
+    glm::vec2 minPixel(1e30f), maxPixel(-1e30f);
+    for (int corner = 0; corner < 4; corner++) {
+        glm::vec4 clip = mvp * glm::vec4((corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, 0.0f, 1.0f);
+        if (clip.w <= 0.0f) return false;
+        glm::vec2 pixel((clip.x / clip.w * 0.5f + 0.5f) * targetWidth, (clip.y / clip.w * 0.5f + 0.5f) * targetHeight);
+        minPixel = glm::min(minPixel, pixel);
+        maxPixel = glm::max(maxPixel, pixel);
     }
+    int x0 = std::max(0, int(std::floor(minPixel.x)) - 1);
+    int y0 = std::max(0, int(std::floor(minPixel.y)) - 1);
+    int x1 = std::min(targetWidth, int(std::ceil(maxPixel.x)) + 1);
+    int y1 = std::min(targetHeight, int(std::ceil(maxPixel.y)) + 1);
+    if (x1 <= x0 || y1 <= y0) return false;
+
+    rect = { x0, y0, x1 - x0, y1 - y0 };
+    return true;
+}
 
+void LiquidGlass::EnsureCacheTexture()
+{
+    // 只增不减，玻璃缩放时不反复重新分配
+    if (m_cacheTexture && m_cacheRect.width <= m_cacheCapacityWidth && m_cacheRect.height <= m_cacheCapacityHeight) {
+        return;
+    }
+
+    m_cacheCapacityWidth = std::max(m_cacheCapacityWidth, m_cacheRect.width);
+    m_cacheCapacityHeight = std::max(m_cacheCapacityHeight, m_cacheRect.height);
+    if (!m_cacheTexture) {
+        glGenTextures(1, &m_cacheTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_cacheTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_cacheCapacityWidth, m_cacheCapacityHeight, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void LiquidGlass::AddCachePass(RenderGraph& graph, RenderResource target, bool store)
+{
+    if (store) {
+        EnsureCacheTexture();
+    }
+    RenderResource cache = graph.ImportTexture("GlassResultCache", m_cacheTexture,
+                                               m_cacheCapacityWidth, m_cacheCapacityHeight);
+
+    // 写入时从目标拷到缓存左下角，命中时反向拷回，都是 1:1 的区域拷贝
+    int x = m_cacheRect.x, y = m_cacheRect.y, width = m_cacheRect.width, height = m_cacheRect.height;
+    RenderResource source = store ? target : cache;
+    RenderResource destination = store ? cache : target;
+    graph.AddPass(store ? "GlassResultStore" : "GlassResultCache", [=](const RenderPassContext& context) {
+        int sourceX = store ? x : 0, sourceY = store ? y : 0;
+        int destinationX = store ? 0 : x, destinationY = store ? 0 : y;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, context.GetFramebuffer(source));
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, context.GetFramebuffer(destination));
+        glBlitFramebuffer(sourceX, sourceY, sourceX + width, sourceY + height,
+                          destinationX, destinationY, destinationX + width, destinationY + height,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }).Read(source).Write(destination);
+}
+
+void LiquidGlass::Draw(GLuint backgroundTexture, GLuint sdfTexture, const glm::mat4& projection, const glm::mat4& view)
+{
     GLboolean depthTestEnabled;
     glGetBooleanv(GL_DEPTH_TEST, &depthTestEnabled);
     
@@ -179,23 +275,28 @@ void LiquidGlass::Render(const glm::mat4& projection, const glm::mat4& view)
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "view"), 1, GL_FALSE, &view[0][0]);
 
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(m_glassPosition.x, m_glassPosition.y, 0.0f));
-    model = glm::scale(model, glm::vec3(m_glassSize.x, m_glassSize.y, 1.0f));
+    glm::mat4 model = GetModelMatrix();
+    SelectMesh(projection * view * model, sdfTexture != 0);
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "model"), 1, GL_FALSE, &model[0][0]);
 
     glUniform3fv(glGetUniformLocation(m_shaderProgram, "materialColor"), 1, &m_material.color[0]);
     glUniform1f(glGetUniformLocation(m_shaderProgram, "materialTransparency"), m_material.transparency);
     
-    glUniform1f(glGetUniformLocation(m_shaderProgram, "ref_height"), g_ref_height);
-    glUniform1f(glGetUniformLocation(m_shaderProgram, "ref_length"), g_ref_length);
+    glUniform1f(glGetUniformLocation(m_shaderProgram, "ref_height"), m_refHeight);
+    glUniform1f(glGetUniformLocation(m_shaderProgram, "ref_length"), m_refLength);
     glUniform1f(glGetUniformLocation(m_shaderProgram, "ref_border_width"), 5.0f);
     glUniform1f(glGetUniformLocation(m_shaderProgram, "ref_exposure"), 1.0f);
     glUniform1f(glGetUniformLocation(m_shaderProgram, "scale"), 1.0f);
+    glUniform1f(glGetUniformLocation(m_shaderProgram, "dispersion"),
+                m_dispersion != GlassDispersion::Off ? m_dispersionStrength : 0.0f);
+    glUniform1f(glGetUniformLocation(m_shaderProgram, "dispersion_lod"),
+                m_dispersion == GlassDispersion::Capped ? kDispersionCappedLod : 0.0f);
 
-    glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    if (m_mesh) {
+        m_mesh->vao.Bind();
+        glDrawElements(GL_TRIANGLES, m_mesh->indexCount, m_mesh->indexType, 0);
+        glBindVertexArray(0);
+    }
     
     glDepthMask(GL_TRUE);
     
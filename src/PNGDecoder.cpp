@@ -0,0 +1,954 @@
+#include "PNGDecoder.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PNG_DECODER_SSE2 1
+#endif
+
+namespace {
+
+const unsigned char kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+// 超过该大小的图像交给 stb_image，避免异常文件申请过多内存
+const size_t kMaxPixels = size_t(1) << 28;
+
+// 小图像拆成作业得不偿失
+const size_t kMinPipelinedBytes = 256 * 1024;
+
+uint32_t ReadU32(const unsigned char* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+// ---------------------------------------------------------------------------
+// inflate
+// ---------------------------------------------------------------------------
+
+struct InputSpan {
+    const unsigned char* data;
+    size_t size;
+};
+
+// 跨多个 IDAT 块读取比特流，不需要先把它们拼接起来
+struct BitReader {
+    const InputSpan* spans;
+    size_t spanCount;
+    size_t span;
+    const unsigned char* pos;
+    const unsigned char* end;
+    uint64_t bits;
+    int count;
+    int padding;
+
+    void Init(const InputSpan* inputSpans, size_t inputCount, size_t offset)
+    {
+        spans = inputSpans;
+        spanCount = inputCount;
+        span = 0;
+        while (span < spanCount && offset >= spans[span].size) {
+            offset -= spans[span].size;
+            span++;
+        }
+        pos = span < spanCount ? spans[span].data + offset : nullptr;
+        end = span < spanCount ? spans[span].data + spans[span].size : nullptr;
+        bits = 0;
+        count = 0;
+        padding = 0;
+    }
+
+    // 保证缓冲区中至少有 56 位；数据读完后补零，padding 记录补了多少字节
+    inline void Refill()
+    {
+        if (end - pos >= 8) {
+            uint64_t v;
+            std::memcpy(&v, pos, 8);    // 假定小端序（x86 / ARM）
+            bits |= v << count;
+            pos += (63 - count) >> 3;
+            count |= 56;
+            return;
+        }
+        while (count <= 56) {
+            while (pos == end && span + 1 < spanCount) {
+                span++;
+                pos = spans[span].data;
+                end = pos + spans[span].size;
+            }
+            if (pos != end) {
+                bits |= uint64_t(*pos++) << count;
+            } else {
+                padding++;
+            }
+            count += 8;
+        }
+    }
+
+    inline uint32_t Read(int n)
+    {
+        if (count < n) Refill();
+        uint32_t v = uint32_t(bits & ((uint64_t(1) << n) - 1));
+        bits >>= n;
+        count -= n;
+        return v;
+    }
+
+    inline void Consume(int n)
+    {
+        bits >>= n;
+        count -= n;
+    }
+
+    void AlignToByte()
+    {
+        Consume(count & 7);
+    }
+
+    // 读到了补出来的零字节，说明数据被截断
+    bool Overrun() const
+    {
+        return padding * 8 > count;
+    }
+
+    // 存储块：先吐出缓冲区中的整字节，再直接从输入拷贝
+    bool CopyBytes(unsigned char* dst, size_t n)
+    {
+        int buffered = count / 8;
+        int realBytes = buffered - std::min(padding, buffered);
+        int drained = 0;
+        while (n > 0 && drained < buffered) {
+            *dst++ = static_cast<unsigned char>(bits & 0xff);
+            Consume(8);
+            drained++;
+            n--;
+        }
+        if (drained > realBytes) return false;
+        if (n == 0) return true;
+        bits = 0;
+        count = 0;
+        while (n > 0) {
+            while (pos == end && span + 1 < spanCount) {
+                span++;
+                pos = spans[span].data;
+                end = pos + spans[span].size;
+            }
+            size_t available = size_t(end - pos);
+            if (available == 0) return false;
+            size_t chunk = std::min(available, n);
+            std::memcpy(dst, pos, chunk);
+            dst += chunk;
+            pos += chunk;
+            n -= chunk;
+        }
+        return true;
+    }
+};
+
+const int kFastBits = 10;
+const uint32_t kFastMask = (1u << kFastBits) - 1;
+
+uint32_t Reverse16(uint32_t v)
+{
+    v = ((v & 0xaaaa) >> 1) | ((v & 0x5555) << 1);
+    v = ((v & 0xcccc) >> 2) | ((v & 0x3333) << 2);
+    v = ((v & 0xf0f0) >> 4) | ((v & 0x0f0f) << 4);
+    v = ((v & 0xff00) >> 8) | ((v & 0x00ff) << 8);
+    return v;
+}
+
+// 范式哈夫曼表：kFastBits 位以内的码一次查表，更长的码按长度逐级比较
+struct HuffmanTable {
+    uint16_t fast[1 << kFastBits];    // (码长 << 9) | 符号，0 表示需要走慢路径
+    uint32_t maxCode[17];
+    uint16_t firstCode[16];
+    uint16_t firstSymbol[16];
+    uint16_t symbols[288];
+
+    bool Build(const uint8_t* lengths, int count)
+    {
+        int lengthCount[16] = {};
+        for (int i = 0; i < count; i++) lengthCount[lengths[i]]++;
+        lengthCount[0] = 0;
+
+        std::memset(fast, 0, sizeof(fast));
+        uint32_t nextCode[16];
+        uint32_t code = 0;
+        int symbol = 0;
+        for (int len = 1; len < 16; len++) {
+            nextCode[len] = code;
+            firstCode[len] = static_cast<uint16_t>(code);
+            firstSymbol[len] = static_cast<uint16_t>(symbol);
+            code += lengthCount[len];
+            if (lengthCount[len] && code - 1 >= (1u << len)) return false;    // 码空间超额
+            maxCode[len] = code << (16 - len);
+            code <<= 1;
+            symbol += lengthCount[len];
+        }
+        maxCode[16] = 0x10000;
+
+        for (int i = 0; i < count; i++) {
+            int len = lengths[i];
+            if (!len) continue;
+            uint32_t c = nextCode[len]++;
+            symbols[c - firstCode[len] + firstSymbol[len]] = static_cast<uint16_t>(i);
+            if (len <= kFastBits) {
+                uint32_t reversed = Reverse16(c) >> (16 - len);
+                for (uint32_t j = reversed; j < (1u << kFastBits); j += 1u << len) {
+                    fast[j] = static_cast<uint16_t>((len << 9) | i);
+                }
+            }
+        }
+        return true;
+    }
+
+    // 调用方保证缓冲区中至少有 15 位
+    inline int Decode(BitReader& br) const
+    {
+        uint32_t entry = fast[br.bits & kFastMask];
+        if (entry) {
+            br.Consume(int(entry >> 9));
+            return int(entry & 511);
+        }
+        uint32_t k = Reverse16(uint32_t(br.bits & 0xffff));
+        int len = kFastBits + 1;
+        while (k >= maxCode[len]) len++;
+        if (len >= 16) return -1;
+        br.Consume(len);
+        return symbols[(k >> (16 - len)) - firstCode[len] + firstSymbol[len]];
+    }
+};
+
+const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                   3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t kDistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                 8193, 12289, 16385, 24577 };
+const uint8_t kDistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+struct FixedTables {
+    HuffmanTable literal;
+    HuffmanTable distance;
+    FixedTables()
+    {
+        uint8_t lengths[288];
+        for (int i = 0; i < 144; i++) lengths[i] = 8;
+        for (int i = 144; i < 256; i++) lengths[i] = 9;
+        for (int i = 256; i < 280; i++) lengths[i] = 7;
+        for (int i = 280; i < 288; i++) lengths[i] = 8;
+        literal.Build(lengths, 288);
+        for (int i = 0; i < 30; i++) lengths[i] = 5;
+        distance.Build(lengths, 30);
+    }
+};
+
+/**
+ * 把 zlib 流解压到 [begin, limit)，反向引用不能越过 begin，因此输出缓冲区本身就是滑动窗口。
+ * progress 每产出约 publishStep 字节调用一次，供反滤波线程跟进。
+ */
+class Inflater {
+public:
+    Inflater(unsigned char* out, size_t begin, size_t limit)
+        : m_out(out), m_begin(begin), m_limit(limit), m_pos(begin), m_publishStep(0), m_nextPublish(SIZE_MAX) {}
+
+    void SetProgress(std::function<void(size_t)> progress, size_t publishStep)
+    {
+        m_progress = std::move(progress);
+        m_publishStep = publishStep;
+        m_nextPublish = m_begin + publishStep;
+    }
+
+    /**
+     * @param zlibHeader 为 true 时先解析 2 字节 zlib 头
+     * @param stopWhenFull 为 true 时输出写满后在块边界停止（分段解码，段尾跟着同步刷新的空存储块）
+     */
+    bool Inflate(const InputSpan* spans, size_t spanCount, size_t offset, bool zlibHeader, bool stopWhenFull)
+    {
+        m_reader.Init(spans, spanCount, offset);
+        if (zlibHeader) {
+            uint32_t cmf = m_reader.Read(8);
+            uint32_t flg = m_reader.Read(8);
+            if ((cmf & 15) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 32)) return false;
+        }
+
+        for (;;) {
+            uint32_t final = m_reader.Read(1);
+            uint32_t type = m_reader.Read(2);
+            bool ok;
+            if (type == 0) {
+                ok = StoredBlock();
+            } else if (type == 1) {
+                static const FixedTables fixed;
+                ok = HuffmanBlock(fixed.literal, fixed.distance);
+            } else if (type == 2) {
+                ok = DynamicBlock();
+            } else {
+                ok = false;
+            }
+            if (!ok || m_reader.Overrun()) return false;
+            if (final || (stopWhenFull && m_pos == m_limit)) break;
+        }
+        Publish();
+        return m_pos == m_limit;
+    }
+
+    size_t GetPosition() const { return m_pos; }
+
+private:
+    void Publish()
+    {
+        if (m_progress) m_progress(m_pos);
+    }
+
+    bool StoredBlock()
+    {
+        m_reader.AlignToByte();
+        uint32_t len = m_reader.Read(16);
+        uint32_t nlen = m_reader.Read(16);
+        if ((len ^ 0xffff) != nlen || len > m_limit - m_pos) return false;
+        if (!m_reader.CopyBytes(m_out + m_pos, len)) return false;
+        m_pos += len;
+        if (m_pos >= m_nextPublish) {
+            Publish();
+            m_nextPublish = m_pos + m_publishStep;
+        }
+        return true;
+    }
+
+    bool DynamicBlock()
+    {
+        static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        int literalCount = int(m_reader.Read(5)) + 257;
+        int distanceCount = int(m_reader.Read(5)) + 1;
+        int codeLengthCount = int(m_reader.Read(4)) + 4;
+        if (literalCount > 286 || distanceCount > 30) return false;
+
+        uint8_t codeLengths[19] = {};
+        for (int i = 0; i < codeLengthCount; i++) {
+            codeLengths[order[i]] = static_cast<uint8_t>(m_reader.Read(3));
+        }
+        HuffmanTable codeLengthTable;
+        if (!codeLengthTable.Build(codeLengths, 19)) return false;
+
+        uint8_t lengths[286 + 30];
+        int total = literalCount + distanceCount;
+        int n = 0;
+        while (n < total) {
+            if (m_reader.count < 16) m_reader.Refill();
+            int symbol = codeLengthTable.Decode(m_reader);
+            if (symbol < 0) return false;
+            if (symbol < 16) {
+                lengths[n++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            int repeat;
+            uint8_t value = 0;
+            if (symbol == 16) {
+                if (n == 0) return false;
+                repeat = 3 + int(m_reader.Read(2));
+                value = lengths[n - 1];
+            } else if (symbol == 17) {
+                repeat = 3 + int(m_reader.Read(3));
+            } else {
+                repeat = 11 + int(m_reader.Read(7));
+            }
+            if (n + repeat > total) return false;
+            std::memset(lengths + n, value, repeat);
+            n += repeat;
+        }
+        if (lengths[256] == 0) return false;
+
+        HuffmanTable literal, distance;
+        if (!literal.Build(lengths, literalCount) || !distance.Build(lengths + literalCount, distanceCount)) {
+            return false;
+        }
+        return HuffmanBlock(literal, distance);
+    }
+
+    bool HuffmanBlock(const HuffmanTable& literal, const HuffmanTable& distance)
+    {
+        // 比特读取器和输出位置放在局部变量里，避免写 unsigned char* 时编译器反复重新加载
+        BitReader br = m_reader;
+        unsigned char* const out = m_out;
+        const size_t begin = m_begin;
+        const size_t limit = m_limit;
+        size_t pos = m_pos;
+        bool ok = true;
+
+        for (;;) {
+            // 一次补满 56 位足够解码一个长度/距离对（15 + 5 + 15 + 13 位）
+            br.Refill();
+            int symbol = literal.Decode(br);
+            if (symbol < 256) {
+                if (symbol < 0 || pos >= limit) {
+                    ok = false;
+                    break;
+                }
+                out[pos++] = static_cast<unsigned char>(symbol);
+            } else if (symbol == 256) {
+                break;
+            } else {
+                symbol -= 257;
+                if (symbol >= 29) {
+                    ok = false;
+                    break;
+                }
+                size_t length = kLengthBase[symbol];
+                if (kLengthExtra[symbol]) {
+                    length += uint32_t(br.bits & ((1u << kLengthExtra[symbol]) - 1));
+                    br.Consume(kLengthExtra[symbol]);
+                }
+                int distSymbol = distance.Decode(br);
+                if (distSymbol < 0 || distSymbol >= 30) {
+                    ok = false;
+                    break;
+                }
+                size_t dist = kDistBase[distSymbol];
+                if (kDistExtra[distSymbol]) {
+                    dist += uint32_t(br.bits & ((1u << kDistExtra[distSymbol]) - 1));
+                    br.Consume(kDistExtra[distSymbol]);
+                }
+                if (dist > pos - begin || length > limit - pos) {
+                    ok = false;
+                    break;
+                }
+
+                unsigned char* dst = out + pos;
+                const unsigned char* src = dst - dist;
+                if (dist >= 8 && limit - pos >= length + 8) {
+                    // 允许多写不超过 7 字节，这些位置随后会被覆盖，且不越过本段的 limit
+                    for (size_t i = 0; i < length; i += 8) {
+                        uint64_t v;
+                        std::memcpy(&v, src + i, 8);
+                        std::memcpy(dst + i, &v, 8);
+                    }
+                } else if (dist == 1) {
+                    std::memset(dst, *src, length);
+                } else {
+                    for (size_t i = 0; i < length; i++) dst[i] = src[i];
+                }
+                pos += length;
+            }
+
+            if (pos >= m_nextPublish) {
+                m_pos = pos;
+                Publish();
+                m_nextPublish = pos + m_publishStep;
+            }
+        }
+
+        m_reader = br;
+        m_pos = pos;
+        return ok;
+    }
+
+    unsigned char* m_out;
+    size_t m_begin;
+    size_t m_limit;
+    size_t m_pos;
+    BitReader m_reader;
+    std::function<void(size_t)> m_progress;
+    size_t m_publishStep;
+    size_t m_nextPublish;
+};
+
+// ---------------------------------------------------------------------------
+// 反滤波
+// ---------------------------------------------------------------------------
+
+inline int Paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+void UnfilterScalar(int filter, const unsigned char* src, const unsigned char* prev, unsigned char* dst,
+                    size_t stride, size_t bpp)
+{
+    switch (filter) {
+    case 1:
+        for (size_t x = 0; x < bpp; x++) dst[x] = src[x];
+        for (size_t x = bpp; x < stride; x++) dst[x] = static_cast<unsigned char>(src[x] + dst[x - bpp]);
+        break;
+    case 2:
+        for (size_t x = 0; x < stride; x++) dst[x] = static_cast<unsigned char>(src[x] + prev[x]);
+        break;
+    case 3:
+        for (size_t x = 0; x < bpp; x++) dst[x] = static_cast<unsigned char>(src[x] + (prev[x] >> 1));
+        for (size_t x = bpp; x < stride; x++) {
+            dst[x] = static_cast<unsigned char>(src[x] + ((dst[x - bpp] + prev[x]) >> 1));
+        }
+        break;
+    case 4:
+        for (size_t x = 0; x < bpp; x++) dst[x] = static_cast<unsigned char>(src[x] + prev[x]);
+        for (size_t x = bpp; x < stride; x++) {
+            dst[x] = static_cast<unsigned char>(src[x] + Paeth(dst[x - bpp], prev[x], prev[x - bpp]));
+        }
+        break;
+    default:
+        std::memcpy(dst, src, stride);
+        break;
+    }
+}
+
+#ifdef PNG_DECODER_SSE2
+// 3/4 字节像素逐像素处理，一个像素的各通道放在同一个寄存器里并行计算
+template <int Bpp>
+inline __m128i LoadPixel(const unsigned char* p)
+{
+    uint32_t v = 0;
+    std::memcpy(&v, p, Bpp);
+    return _mm_cvtsi32_si128(int(v));
+}
+
+template <int Bpp>
+inline void StorePixel(unsigned char* p, __m128i v)
+{
+    uint32_t x = uint32_t(_mm_cvtsi128_si32(v));
+    std::memcpy(p, &x, Bpp);
+}
+
+template <int Bpp>
+void UnfilterSubSSE2(const unsigned char* src, unsigned char* dst, size_t stride)
+{
+    __m128i a = _mm_setzero_si128();
+    for (size_t x = 0; x < stride; x += Bpp) {
+        a = _mm_add_epi8(a, LoadPixel<Bpp>(src + x));
+        StorePixel<Bpp>(dst + x, a);
+    }
+}
+
+void UnfilterUpSSE2(const unsigned char* src, const unsigned char* prev, unsigned char* dst, size_t stride)
+{
+    size_t x = 0;
+    for (; x + 16 <= stride; x += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_add_epi8(s, b));
+    }
+    for (; x < stride; x++) dst[x] = static_cast<unsigned char>(src[x] + prev[x]);
+}
+
+template <int Bpp>
+void UnfilterAvgSSE2(const unsigned char* src, const unsigned char* prev, unsigned char* dst, size_t stride)
+{
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i a = _mm_setzero_si128();
+    for (size_t x = 0; x < stride; x += Bpp) {
+        __m128i b = LoadPixel<Bpp>(prev + x);
+        // _mm_avg_epu8 向上取整，减去 (a ^ b) & 1 得到向下取整的平均值
+        __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+        a = _mm_add_epi8(LoadPixel<Bpp>(src + x), avg);
+        StorePixel<Bpp>(dst + x, a);
+    }
+}
+
+inline __m128i Abs16(__m128i v)
+{
+    return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+}
+
+inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+template <int Bpp>
+void UnfilterPaethSSE2(const unsigned char* src, const unsigned char* prev, unsigned char* dst, size_t stride)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero, c = zero;
+    for (size_t x = 0; x < stride; x += Bpp) {
+        __m128i b = _mm_unpacklo_epi8(LoadPixel<Bpp>(prev + x), zero);
+        // p = a + b - c，于是 p - a = b - c，p - b = a - c，p - c = (b - c) + (a - c)
+        __m128i bc = _mm_sub_epi16(b, c);
+        __m128i ac = _mm_sub_epi16(a, c);
+        __m128i pa = Abs16(bc);
+        __m128i pb = Abs16(ac);
+        __m128i pc = Abs16(_mm_add_epi16(bc, ac));
+
+        __m128i useB = _mm_xor_si128(_mm_cmpgt_epi16(pb, pc), _mm_set1_epi16(-1));
+        __m128i useA = _mm_xor_si128(_mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc)),
+                                     _mm_set1_epi16(-1));
+        __m128i predicted = Select(useA, a, Select(useB, b, c));
+
+        __m128i value = _mm_add_epi8(LoadPixel<Bpp>(src + x), _mm_packus_epi16(predicted, predicted));
+        StorePixel<Bpp>(dst + x, value);
+        a = _mm_unpacklo_epi8(value, zero);
+        c = b;
+    }
+}
+
+template <int Bpp>
+void UnfilterSSE2(int filter, const unsigned char* src, const unsigned char* prev, unsigned char* dst, size_t stride)
+{
+    switch (filter) {
+    case 1: UnfilterSubSSE2<Bpp>(src, dst, stride); break;
+    case 2: UnfilterUpSSE2(src, prev, dst, stride); break;
+    case 3: UnfilterAvgSSE2<Bpp>(src, prev, dst, stride); break;
+    case 4: UnfilterPaethSSE2<Bpp>(src, prev, dst, stride); break;
+    default: std::memcpy(dst, src, stride); break;
+    }
+}
+#endif
+
+bool UnfilterRow(int filter, const unsigned char* src, const unsigned char* prev, unsigned char* dst,
+                 size_t stride, size_t bpp)
+{
+    if (filter > 4) return false;
+#ifdef PNG_DECODER_SSE2
+    if (bpp == 4) {
+        UnfilterSSE2<4>(filter, src, prev, dst, stride);
+        return true;
+    }
+    if (bpp == 3) {
+        UnfilterSSE2<3>(filter, src, prev, dst, stride);
+        return true;
+    }
+    if (filter == 2) {
+        UnfilterUpSSE2(src, prev, dst, stride);
+        return true;
+    }
+#endif
+    UnfilterScalar(filter, src, prev, dst, stride, bpp);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// 解码流程
+// ---------------------------------------------------------------------------
+
+enum ColorType {
+    kGray = 0,
+    kRGB = 2,
+    kPalette = 3,
+    kGrayAlpha = 4,
+    kRGBA = 6
+};
+
+struct Segment {
+    uint32_t firstRow;
+    uint32_t offset;
+};
+
+struct DecodeState {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int colorType = 0;
+    size_t bpp = 0;            // 源数据每像素字节数
+    size_t stride = 0;         // 源数据行字节数（不含滤波类型字节）
+    int channels = 0;          // 输出通道数
+    unsigned char palette[256][4] = {};
+    std::vector<InputSpan> spans;
+    std::vector<Segment> segments;
+    std::vector<unsigned char> filtered;
+    unsigned char* out = nullptr;
+
+    size_t RowBytes() const { return stride + 1; }
+
+    // 源格式和输出格式一致时，反滤波直接写进输出图像
+    bool Direct() const
+    {
+        return (colorType == kRGB && channels == 3) || (colorType == kRGBA && channels == 4);
+    }
+};
+
+void ExpandRow(const DecodeState& state, const unsigned char* src, unsigned char* dst)
+{
+    const uint32_t width = state.width;
+    const int channels = state.channels;
+    switch (state.colorType) {
+    case kGray:
+        for (uint32_t x = 0; x < width; x++, dst += channels) {
+            dst[0] = dst[1] = dst[2] = src[x];
+            if (channels == 4) dst[3] = 255;
+        }
+        break;
+    case kGrayAlpha:
+        for (uint32_t x = 0; x < width; x++, dst += channels) {
+            dst[0] = dst[1] = dst[2] = src[x * 2];
+            if (channels == 4) dst[3] = src[x * 2 + 1];
+        }
+        break;
+    case kPalette:
+        for (uint32_t x = 0; x < width; x++, dst += channels) {
+            std::memcpy(dst, state.palette[src[x]], channels);
+        }
+        break;
+    case kRGB:
+        for (uint32_t x = 0; x < width; x++, dst += 4) {
+            dst[0] = src[x * 3];
+            dst[1] = src[x * 3 + 1];
+            dst[2] = src[x * 3 + 2];
+            dst[3] = 255;
+        }
+        break;
+    case kRGBA:
+        for (uint32_t x = 0; x < width; x++, dst += 3) {
+            dst[0] = src[x * 4];
+            dst[1] = src[x * 4 + 1];
+            dst[2] = src[x * 4 + 2];
+        }
+        break;
+    }
+}
+
+/**
+ * 逐行反滤波并展开 [rowBegin, rowEnd)。非直接输出时需要两行暂存：scratch 大小为 2 * stride。
+ * 段首行 prev 为空时只允许不引用上一行的滤波器。
+ */
+class RowProcessor {
+public:
+    RowProcessor(DecodeState& state) : m_state(state), m_zeroRow(state.stride, 0)
+    {
+        if (!state.Direct()) m_scratch.resize(state.stride * 2);
+    }
+
+    bool Process(uint32_t row, bool segmentStart)
+    {
+        const size_t stride = m_state.stride;
+        const unsigned char* src = m_state.filtered.data() + m_state.RowBytes() * row;
+        int filter = src[0];
+        if (segmentStart && row > 0 && filter >= 2) return false;
+
+        const size_t outStride = size_t(m_state.width) * m_state.channels;
+        unsigned char* dst;
+        const unsigned char* prev;
+        if (m_state.Direct()) {
+            dst = m_state.out + outStride * row;
+            prev = (row == 0 || segmentStart) ? m_zeroRow.data() : dst - outStride;
+        } else {
+            dst = m_scratch.data() + stride * (row & 1);
+            prev = (row == 0 || segmentStart) ? m_zeroRow.data() : m_scratch.data() + stride * ((row + 1) & 1);
+        }
+        if (!UnfilterRow(filter, src + 1, prev, dst, stride, m_state.bpp)) return false;
+        if (!m_state.Direct()) {
+            ExpandRow(m_state, dst, m_state.out + outStride * row);
+        }
+        return true;
+    }
+
+private:
+    DecodeState& m_state;
+    std::vector<unsigned char> m_zeroRow;
+    std::vector<unsigned char> m_scratch;
+};
+
+bool DecodeSequential(DecodeState& state)
+{
+    Inflater inflater(state.filtered.data(), 0, state.filtered.size());
+    if (!inflater.Inflate(state.spans.data(), state.spans.size(), 0, true, false)) return false;
+
+    RowProcessor rows(state);
+    for (uint32_t y = 0; y < state.height; y++) {
+        if (!rows.Process(y, false)) return false;
+    }
+    return true;
+}
+
+// 调用线程 inflate，每产出一批完整的行就提交一个反滤波作业；反滤波依赖上一行，
+// 各作业按提交顺序链接（RunAfter），与后续的 inflate 重叠执行
+bool DecodePipelined(DecodeState& state)
+{
+    JobSystem& jobs = JobSystem::Shared();
+    // 作业依次执行，共用一个 RowProcessor；deque 追加时不移动已有的计数
+    RowProcessor rows(state);
+    std::deque<JobCounter> stages(1);
+    std::atomic<bool> rowsFailed(false);
+    uint32_t rowsQueued = 0;
+
+    auto publish = [&](size_t position) {
+        uint32_t available = uint32_t(std::min<size_t>(position / state.RowBytes(), state.height));
+        if (available <= rowsQueued) return;
+        uint32_t begin = rowsQueued;
+        rowsQueued = available;
+        JobCounter& previous = stages.back();
+        stages.emplace_back();
+        jobs.RunAfter(previous, [&rows, &rowsFailed, begin, available]() {
+            for (uint32_t y = begin; y < available && !rowsFailed; y++) {
+                if (!rows.Process(y, false)) rowsFailed = true;
+            }
+        }, &stages.back());
+    };
+
+    Inflater inflater(state.filtered.data(), 0, state.filtered.size());
+    inflater.SetProgress(publish, std::max<size_t>(state.RowBytes() * 8, 64 * 1024));
+    bool ok = inflater.Inflate(state.spans.data(), state.spans.size(), 0, true, false);
+    if (ok) {
+        publish(state.filtered.size());
+    } else {
+        rowsFailed = true;
+    }
+
+    // 前面的计数在释放后续作业时仍会被访问，全部等完才能销毁
+    for (JobCounter& stage : stages) {
+        jobs.Wait(stage);
+    }
+    return ok && !rowsFailed;
+}
+
+// 各段从独立的 deflate 块边界开始且首行不引用上一行，可以完全并行
+bool DecodeSegments(DecodeState& state)
+{
+    std::atomic<bool> failed(false);
+    JobSystem::Shared().ParallelFor(0, state.segments.size(), [&state, &failed](size_t first, size_t last) {
+        const size_t segmentCount = state.segments.size();
+        RowProcessor rows(state);
+        for (size_t index = first; index < last && !failed; index++) {
+            const Segment& segment = state.segments[index];
+            uint32_t rowEnd = index + 1 < segmentCount ? state.segments[index + 1].firstRow : state.height;
+            size_t begin = state.RowBytes() * segment.firstRow;
+            size_t limit = state.RowBytes() * rowEnd;
+            Inflater inflater(state.filtered.data(), begin, limit);
+            bool ok = inflater.Inflate(state.spans.data(), state.spans.size(), segment.offset,
+                                       index == 0, true);
+            for (uint32_t y = segment.firstRow; ok && y < rowEnd; y++) {
+                ok = rows.Process(y, y == segment.firstRow);
+            }
+            if (!ok) failed = true;
+        }
+    });
+    return !failed;
+}
+
+// 段索引必须严格递增并落在数据范围内，否则按普通 PNG 解码
+bool ValidSegments(const DecodeState& state, size_t idatSize)
+{
+    const std::vector<Segment>& segments = state.segments;
+    if (segments.size() < 2 || segments[0].firstRow != 0 || segments[0].offset != 0) return false;
+    for (size_t i = 1; i < segments.size(); i++) {
+        if (segments[i].firstRow <= segments[i - 1].firstRow || segments[i].firstRow >= state.height ||
+            segments[i].offset <= segments[i - 1].offset || segments[i].offset >= idatSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+bool PNGDecoder::isPNG(const unsigned char* data, size_t size)
+{
+    return size >= sizeof(kSignature) && std::memcmp(data, kSignature, sizeof(kSignature)) == 0;
+}
+
+bool PNGDecoder::decode(const unsigned char* data, size_t size, int desiredChannels, PNGImage& image,
+                        bool parallel)
+{
+    if (!isPNG(data, size) || (desiredChannels != 0 && desiredChannels != 3 && desiredChannels != 4)) {
+        return false;
+    }
+
+    DecodeState state;
+    bool hasHeader = false;
+    bool hasTransparency = false;
+    int paletteSize = 0;
+    size_t idatSize = 0;
+
+    // 与 stb_image 一样不校验块 CRC 和 Adler-32
+    size_t offset = sizeof(kSignature);
+    while (offset + 12 <= size) {
+        uint32_t length = ReadU32(data + offset);
+        const unsigned char* type = data + offset + 4;
+        const unsigned char* body = data + offset + 8;
+        if (length > size - offset - 12) return false;
+        offset += size_t(length) + 12;
+
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13) return false;
+            state.width = ReadU32(body);
+            state.height = ReadU32(body + 4);
+            int bitDepth = body[8];
+            state.colorType = body[9];
+            // 16 位、低位深和隔行扫描交给 stb_image
+            if (bitDepth != 8 || body[10] != 0 || body[11] != 0 || body[12] != 0) return false;
+            if (state.width == 0 || state.height == 0 ||
+                size_t(state.width) * state.height > kMaxPixels) return false;
+            switch (state.colorType) {
+            case kGray: state.bpp = 1; break;
+            case kRGB: state.bpp = 3; break;
+            case kPalette: state.bpp = 1; break;
+            case kGrayAlpha: state.bpp = 2; break;
+            case kRGBA: state.bpp = 4; break;
+            default: return false;
+            }
+            hasHeader = true;
+        } else if (!hasHeader) {
+            return false;
+        } else if (std::memcmp(type, "PLTE", 4) == 0) {
+            if (length % 3 != 0 || length / 3 > 256) return false;
+            paletteSize = int(length / 3);
+            for (int i = 0; i < paletteSize; i++) {
+                state.palette[i][0] = body[i * 3];
+                state.palette[i][1] = body[i * 3 + 1];
+                state.palette[i][2] = body[i * 3 + 2];
+                state.palette[i][3] = 255;
+            }
+        } else if (std::memcmp(type, "tRNS", 4) == 0) {
+            // 灰度/RGB 的色键透明需要逐像素比较，交给 stb_image
+            if (state.colorType != kPalette || int(length) > paletteSize) return false;
+            for (uint32_t i = 0; i < length; i++) state.palette[i][3] = body[i];
+            hasTransparency = true;
+        } else if (std::memcmp(type, "lgIX", 4) == 0) {
+            uint32_t count = length >= 4 ? ReadU32(body) : 0;
+            if (count > 0 && length == 4 + count * 8) {
+                state.segments.resize(count);
+                for (uint32_t i = 0; i < count; i++) {
+                    state.segments[i].firstRow = ReadU32(body + 4 + i * 8);
+                    state.segments[i].offset = ReadU32(body + 8 + i * 8);
+                }
+            }
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            if (length > 0) state.spans.push_back({ body, length });
+            idatSize += length;
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        } else if (!(type[0] & 0x20)) {
+            return false;    // 未知的关键块
+        }
+    }
+    if (!hasHeader || state.spans.empty() || (state.colorType == kPalette && paletteSize == 0)) return false;
+
+    bool sourceAlpha = state.colorType == kGrayAlpha || state.colorType == kRGBA || hasTransparency;
+    state.channels = desiredChannels != 0 ? desiredChannels : (sourceAlpha ? 4 : 3);
+    state.stride = size_t(state.width) * state.bpp;
+
+    image.width = int(state.width);
+    image.height = int(state.height);
+    image.channels = state.channels;
+    image.pixels.resize(size_t(state.width) * state.height * state.channels);
+    state.out = image.pixels.data();
+    state.filtered.resize(state.RowBytes() * state.height);
+
+    if (parallel && ValidSegments(state, idatSize) && DecodeSegments(state)) {
+        return true;
+    }
+    if (parallel && state.filtered.size() >= kMinPipelinedBytes) {
+        return DecodePipelined(state);
+    }
+    return DecodeSequential(state);
+}
+
+bool PNGDecoder::load(const std::string& path, int desiredChannels, PNGImage& image, bool parallel)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::streamsize size = file.tellg();
+    if (size <= 0) return false;
+
+    std::vector<unsigned char> data(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) return false;
+    return decode(data.data(), data.size(), desiredChannels, image, parallel);
+}
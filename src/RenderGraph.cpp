@@ -0,0 +1,475 @@
+#include "RenderGraph.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+struct PixelFormat {
+    GLenum format;
+    GLenum type;
+    size_t bytesPerPixel;
+};
+
+PixelFormat GetPixelFormat(GLenum internalFormat)
+{
+    switch (internalFormat) {
+    case GL_R8:                return { GL_RED, GL_UNSIGNED_BYTE, 1 };
+    case GL_RG8:               return { GL_RG, GL_UNSIGNED_BYTE, 2 };
+    case GL_R16F:              return { GL_RED, GL_HALF_FLOAT, 2 };
+    case GL_RG16F:             return { GL_RG, GL_HALF_FLOAT, 4 };
+    case GL_RGBA16F:           return { GL_RGBA, GL_HALF_FLOAT, 8 };
+    case GL_DEPTH24_STENCIL8:  return { GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, 4 };
+    case GL_DEPTH_COMPONENT24: return { GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 4 };
+    default:                   return { GL_RGBA, GL_UNSIGNED_BYTE, 4 };
+    }
+}
+
+}
+
+GLuint RenderPassContext::GetTexture(RenderResource resource) const
+{
+    return m_graph.m_resources[resource].texture;
+}
+
+GLuint RenderPassContext::GetFramebuffer(RenderResource resource) const
+{
+    const RenderGraph::Resource& entry = m_graph.m_resources[resource];
+    if (entry.backbuffer) return 0;
+    return m_graph.GetFramebuffer(entry.texture, 0);
+}
+
+const RenderTextureDesc& RenderPassContext::GetDesc(RenderResource resource) const
+{
+    return m_graph.m_resources[resource].desc;
+}
+
+void RenderPassContext::BindTarget() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_width, m_height);
+}
+
+RenderPassBuilder& RenderPassBuilder::Read(RenderResource resource)
+{
+    RenderGraph::Pass& pass = m_graph.m_passes[m_pass];
+    if (resource == kInvalidRenderResource) return *this;
+    if (pass.readCount == RenderGraph::kMaxPassReads) {
+        std::cerr << "RenderGraph: Too many reads in pass " << pass.name << std::endl;
+        return *this;
+    }
+    pass.reads[pass.readCount++] = resource;
+    return *this;
+}
+
+RenderPassBuilder& RenderPassBuilder::Write(RenderResource resource)
+{
+    RenderGraph::Pass& pass = m_graph.m_passes[m_pass];
+    if (resource == kInvalidRenderResource) return *this;
+    if (pass.writeCount == RenderGraph::kMaxPassWrites) {
+        std::cerr << "RenderGraph: Too many writes in pass " << pass.name << std::endl;
+        return *this;
+    }
+    pass.writes[pass.writeCount++] = resource;
+    return *this;
+}
+
+RenderPassBuilder& RenderPassBuilder::SideEffect()
+{
+    m_graph.m_passes[m_pass].sideEffect = true;
+    return *this;
+}
+
+RenderGraph::RenderGraph()
+    : m_arena(nullptr), m_frame(0), m_scissorBackbuffer(false), m_scissor{ 0, 0, 0, 0 }
+    , m_executedPasses(0), m_culledPasses(0), m_profiling(false), m_timerQueries(), m_timerNames(), m_timerCounts()
+    , m_droppedTimings(0)
+{
+    m_passes.reserve(32);
+    m_resources.reserve(32);
+    m_textures.reserve(16);
+    m_framebuffers.reserve(16);
+}
+
+RenderGraph::~RenderGraph()
+{
+    Cleanup();
+}
+
+void RenderGraph::BeginFrame(FrameArena& arena)
+{
+    m_arena = &arena;
+    m_passes.clear();
+    m_resources.clear();
+    m_frame++;
+    m_scissorBackbuffer = false;
+}
+
+void RenderGraph::SetBackbufferScissor(int x, int y, int width, int height)
+{
+    m_scissorBackbuffer = true;
+    m_scissor[0] = x;
+    m_scissor[1] = y;
+    m_scissor[2] = width;
+    m_scissor[3] = height;
+}
+
+RenderResource RenderGraph::AddResource(const Resource& resource)
+{
+    m_resources.push_back(resource);
+    return RenderResource(m_resources.size() - 1);
+}
+
+RenderResource RenderGraph::ImportBackbuffer(int width, int height)
+{
+    Resource resource = {};
+    resource.name = "Backbuffer";
+    resource.desc = { width, height, GL_RGBA8 };
+    resource.imported = true;
+    resource.backbuffer = true;
+    resource.physical = -1;
+    return AddResource(resource);
+}
+
+RenderResource RenderGraph::ImportTexture(const char* name, GLuint texture, int width, int height, GLenum format)
+{
+    Resource resource = {};
+    resource.name = name;
+    resource.desc = { width, height, format };
+    resource.texture = texture;
+    resource.imported = true;
+    resource.physical = -1;
+    return AddResource(resource);
+}
+
+RenderResource RenderGraph::CreateTexture(const char* name, const RenderTextureDesc& desc)
+{
+    Resource resource = {};
+    resource.name = name;
+    resource.desc = desc;
+    resource.physical = -1;
+    return AddResource(resource);
+}
+
+RenderPassBuilder RenderGraph::AppendPass(const char* name, void* closure, ExecuteFunction execute)
+{
+    Pass pass = {};
+    pass.name = name;
+    pass.closure = closure;
+    pass.execute = execute;
+    m_passes.push_back(pass);
+    return RenderPassBuilder(*this, int(m_passes.size() - 1));
+}
+
+bool RenderGraph::IsDepthFormat(GLenum format)
+{
+    return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH_COMPONENT24;
+}
+
+void RenderGraph::Compile()
+{
+    // pass 按添加顺序执行，写入者总在读取者之前，所以一次反向遍历就能确定哪些输出有人使用
+    m_culledPasses = 0;
+    for (int i = int(m_passes.size()) - 1; i >= 0; i--) {
+        Pass& pass = m_passes[i];
+        bool needed = pass.sideEffect;
+        for (int w = 0; w < pass.writeCount && !needed; w++) {
+            const Resource& resource = m_resources[pass.writes[w]];
+            needed = resource.imported || resource.needed;
+        }
+        pass.culled = !needed;
+        if (!needed) {
+            m_culledPasses++;
+            continue;
+        }
+        for (int r = 0; r < pass.readCount; r++) {
+            m_resources[pass.reads[r]].needed = true;
+        }
+    }
+
+    for (Resource& resource : m_resources) {
+        resource.firstPass = -1;
+        resource.lastPass = -1;
+    }
+    for (int i = 0; i < int(m_passes.size()); i++) {
+        const Pass& pass = m_passes[i];
+        if (pass.culled) continue;
+        for (int r = 0; r < pass.readCount + pass.writeCount; r++) {
+            RenderResource handle = r < pass.readCount ? pass.reads[r] : pass.writes[r - pass.readCount];
+            Resource& resource = m_resources[handle];
+            if (resource.firstPass < 0) resource.firstPass = i;
+            resource.lastPass = i;
+        }
+    }
+}
+
+void RenderGraph::AcquireTexture(Resource& resource)
+{
+    // 优先复用本帧已经释放的同规格纹理，其次是前几帧留下的
+    for (size_t i = 0; i < m_textures.size(); i++) {
+        PhysicalTexture& texture = m_textures[i];
+        if (!texture.inUse && texture.desc == resource.desc) {
+            texture.inUse = true;
+            texture.lastUsedFrame = m_frame;
+            resource.physical = int(i);
+            resource.texture = texture.texture;
+            return;
+        }
+    }
+
+    PixelFormat pixelFormat = GetPixelFormat(resource.desc.format);
+    PhysicalTexture texture;
+    glGenTextures(1, &texture.texture);
+    glBindTexture(GL_TEXTURE_2D, texture.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, resource.desc.format, resource.desc.width, resource.desc.height, 0,
+                 pixelFormat.format, pixelFormat.type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    texture.desc = resource.desc;
+    texture.inUse = true;
+    texture.lastUsedFrame = m_frame;
+    m_textures.push_back(texture);
+
+    resource.physical = int(m_textures.size() - 1);
+    resource.texture = texture.texture;
+}
+
+GLuint RenderGraph::GetFramebuffer(GLuint color, GLuint depth)
+{
+    for (CachedFramebuffer& framebuffer : m_framebuffers) {
+        if (framebuffer.color == color && framebuffer.depth == depth) {
+            framebuffer.lastUsedFrame = m_frame;
+            return framebuffer.fbo;
+        }
+    }
+
+    CachedFramebuffer framebuffer;
+    framebuffer.color = color;
+    framebuffer.depth = depth;
+    framebuffer.lastUsedFrame = m_frame;
+    glGenFramebuffers(1, &framebuffer.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.fbo);
+    if (color) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+    } else {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    if (depth) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+    }
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "RenderGraph: Framebuffer is not complete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_framebuffers.push_back(framebuffer);
+    return framebuffer.fbo;
+}
+
+void RenderGraph::Execute()
+{
+    Compile();
+
+    m_executedPasses = 0;
+    bool scissorEnabled = false;
+    // 这一组查询是 kProfileLatency 帧之前发出的，先取回结果再复用
+    int timerSlot = m_frame % kProfileLatency;
+    int timerCount = 0;
+    if (m_profiling) {
+        CollectTimings(timerSlot);
+    }
+    for (int i = 0; i < int(m_passes.size()); i++) {
+        const Pass& pass = m_passes[i];
+        if (pass.culled) continue;
+
+        for (int w = 0; w < pass.writeCount; w++) {
+            Resource& resource = m_resources[pass.writes[w]];
+            if (!resource.imported && resource.firstPass == i) {
+                AcquireTexture(resource);
+            }
+        }
+        for (int r = 0; r < pass.readCount; r++) {
+            const Resource& resource = m_resources[pass.reads[r]];
+            if (!resource.imported && resource.physical < 0) {
+                std::cerr << "RenderGraph: Pass " << pass.name << " reads " << resource.name
+                          << " before anything writes it" << std::endl;
+            }
+        }
+
+        // 目标：后台缓冲直接用 0，否则按 (颜色, 深度) 组合取缓存的 FBO
+        GLuint framebuffer = 0;
+        int width = 0, height = 0;
+        bool backbuffer = false;
+        GLuint color = 0, depth = 0;
+        for (int w = 0; w < pass.writeCount; w++) {
+            const Resource& resource = m_resources[pass.writes[w]];
+            width = resource.desc.width;
+            height = resource.desc.height;
+            if (resource.backbuffer) {
+                backbuffer = true;
+            } else if (IsDepthFormat(resource.desc.format)) {
+                depth = resource.texture;
+            } else {
+                color = resource.texture;
+            }
+        }
+        if (!backbuffer && (color || depth)) {
+            framebuffer = GetFramebuffer(color, depth);
+        }
+
+        // 裁剪测试同样作用于清屏和 blit，只能对写后台缓冲的 pass 打开
+        bool scissor = backbuffer && m_scissorBackbuffer;
+        if (scissor != scissorEnabled) {
+            if (scissor) {
+                glEnable(GL_SCISSOR_TEST);
+                glScissor(m_scissor[0], m_scissor[1], m_scissor[2], m_scissor[3]);
+            } else {
+                glDisable(GL_SCISSOR_TEST);
+            }
+            scissorEnabled = scissor;
+        }
+
+        RenderPassContext context(*this, framebuffer, width, height);
+        bool timed = m_profiling && timerCount < kMaxProfiledPasses;
+        if (timed) {
+            m_timerNames[timerSlot][timerCount] = pass.name;
+            glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[timerSlot][timerCount]);
+        }
+        pass.execute(pass.closure, context);
+        if (timed) {
+            glEndQuery(GL_TIME_ELAPSED);
+            timerCount++;
+        }
+        m_executedPasses++;
+
+        // 最后一次使用之后归还，后面的 pass 可以复用同一张纹理
+        for (int r = 0; r < pass.readCount + pass.writeCount; r++) {
+            RenderResource handle = r < pass.readCount ? pass.reads[r] : pass.writes[r - pass.readCount];
+            Resource& resource = m_resources[handle];
+            if (resource.physical >= 0 && resource.lastPass == i) {
+                m_textures[resource.physical].inUse = false;
+                resource.physical = -1;
+            }
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (scissorEnabled) {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    if (m_profiling) {
+        m_timerCounts[timerSlot] = timerCount;
+    }
+
+    ReleaseUnused();
+}
+
+void RenderGraph::SetProfiling(bool enabled)
+{
+    if (enabled == m_profiling) return;
+    if (enabled) {
+        for (int slot = 0; slot < kProfileLatency; slot++) {
+            glGenQueries(kMaxProfiledPasses, m_timerQueries[slot]);
+            m_timerCounts[slot] = 0;
+        }
+        // 名称种类不超过每帧查询数，预留后统计期间不再分配
+        m_passTimings.reserve(kMaxProfiledPasses);
+    } else {
+        for (int slot = 0; slot < kProfileLatency; slot++) {
+            glDeleteQueries(kMaxProfiledPasses, m_timerQueries[slot]);
+            m_timerCounts[slot] = 0;
+        }
+    }
+    m_profiling = enabled;
+}
+
+void RenderGraph::CollectTimings(int slot)
+{
+    for (int i = 0; i < m_timerCounts[slot]; i++) {
+        // GPU 落后超过 kProfileLatency 帧时结果还没出来，直接读会阻塞到它完成；
+        // 这一组查询马上要复用，没出来的结果只能丢弃。同一帧的查询按顺序完成，后面的也不会就绪
+        GLuint available = 0;
+        glGetQueryObjectuiv(m_timerQueries[slot][i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            m_droppedTimings += m_timerCounts[slot] - i;
+            break;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m_timerQueries[slot][i], GL_QUERY_RESULT, &elapsed);
+
+        const char* name = m_timerNames[slot][i];
+        PassTiming* timing = nullptr;
+        for (PassTiming& existing : m_passTimings) {
+            if (std::strcmp(existing.name, name) == 0) {
+                timing = &existing;
+                break;
+            }
+        }
+        if (!timing) {
+            if (m_passTimings.size() == m_passTimings.capacity()) continue;
+            m_passTimings.push_back({ name, 0.0, 0 });
+            timing = &m_passTimings.back();
+        }
+        timing->totalMilliseconds += double(elapsed) / 1.0e6;
+        timing->samples++;
+    }
+    m_timerCounts[slot] = 0;
+}
+
+double RenderGraph::GetAveragePassTime(const char* name) const
+{
+    for (const PassTiming& timing : m_passTimings) {
+        if (std::strcmp(timing.name, name) == 0 && timing.samples > 0) {
+            return timing.totalMilliseconds / timing.samples;
+        }
+    }
+    return 0.0;
+}
+
+void RenderGraph::ReleaseUnused()
+{
+    // FBO 只在其附件被使用时刷新帧号，附件过期时 FBO 必然也已过期，两者一起删除
+    for (size_t i = 0; i < m_framebuffers.size(); ) {
+        if (m_frame - m_framebuffers[i].lastUsedFrame < kTextureRetainFrames) {
+            i++;
+            continue;
+        }
+        glDeleteFramebuffers(1, &m_framebuffers[i].fbo);
+        m_framebuffers[i] = m_framebuffers.back();
+        m_framebuffers.pop_back();
+    }
+    for (size_t i = 0; i < m_textures.size(); ) {
+        if (m_frame - m_textures[i].lastUsedFrame < kTextureRetainFrames) {
+            i++;
+            continue;
+        }
+        glDeleteTextures(1, &m_textures[i].texture);
+        m_textures[i] = m_textures.back();
+        m_textures.pop_back();
+    }
+}
+
+size_t RenderGraph::GetTextureMemory() const
+{
+    size_t bytes = 0;
+    for (const PhysicalTexture& texture : m_textures) {
+        bytes += size_t(texture.desc.width) * texture.desc.height * GetPixelFormat(texture.desc.format).bytesPerPixel;
+    }
+    return bytes;
+}
+
+void RenderGraph::Cleanup()
+{
+    SetProfiling(false);
+    for (CachedFramebuffer& framebuffer : m_framebuffers) {
+        glDeleteFramebuffers(1, &framebuffer.fbo);
+    }
+    for (PhysicalTexture& texture : m_textures) {
+        glDeleteTextures(1, &texture.texture);
+    }
+    m_framebuffers.clear();
+    m_textures.clear();
+    m_passes.clear();
+    m_resources.clear();
+}
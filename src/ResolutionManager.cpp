@@ -0,0 +1,65 @@
+#include "ResolutionManager.h"
+#include <algorithm>
+#include <cmath>
+
+ResolutionManager::ResolutionManager()
+    : m_width(0), m_height(0), m_targetWidth(0), m_targetHeight(0), m_maxTargetSize(16384)
+    , m_framesSinceResize(0), m_resizeCount(0), m_targetReallocations(0)
+{
+}
+
+void ResolutionManager::Initialize(int width, int height, int maxTargetSize)
+{
+    m_maxTargetSize = std::max(maxTargetSize, 1);
+    m_width = width;
+    m_height = height;
+    m_targetWidth = std::min(width, m_maxTargetSize);
+    m_targetHeight = std::min(height, m_maxTargetSize);
+    m_framesSinceResize = 0;
+    Notify();
+}
+
+int ResolutionManager::Grow(int capacity, int required) const
+{
+    if (required <= capacity) return capacity;
+    int grown = int(std::ceil(capacity * kGrowthFactor));
+    return std::min(std::max(required, grown), m_maxTargetSize);
+}
+
+void ResolutionManager::Resize(int width, int height)
+{
+    if (width == m_width && height == m_height) return;
+
+    m_width = width;
+    m_height = height;
+    m_framesSinceResize = 0;
+    m_resizeCount++;
+
+    int targetWidth = Grow(m_targetWidth, width);
+    int targetHeight = Grow(m_targetHeight, height);
+    if (targetWidth != m_targetWidth || targetHeight != m_targetHeight) {
+        m_targetWidth = targetWidth;
+        m_targetHeight = targetHeight;
+        m_targetReallocations++;
+    }
+    Notify();
+}
+
+void ResolutionManager::Update()
+{
+    if (m_targetWidth == m_width && m_targetHeight == m_height) return;
+    // 最小化时尺寸为 0，不把容量收缩到 0
+    if (m_width <= 0 || m_height <= 0) return;
+    if (++m_framesSinceResize < kShrinkCooldownFrames) return;
+
+    m_targetWidth = std::min(m_width, m_maxTargetSize);
+    m_targetHeight = std::min(m_height, m_maxTargetSize);
+    m_targetReallocations++;
+}
+
+void ResolutionManager::Notify()
+{
+    for (const Listener& listener : m_listeners) {
+        listener(m_width, m_height);
+    }
+}
@@ -0,0 +1,395 @@
+#include "SDFAtlas.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const float kFar = 1e20f;
+// 每个作业至少处理的纹素数，小图不值得拆分
+const size_t kMinTexelsPerJob = 16 * 1024;
+
+// Felzenszwalb 一维平方距离变换：d[q] = min_p (q - p)^2 + f[p]
+void DistanceTransform1D(const float* f, int n, float* d, int* v, float* z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -kFar;
+    z[1] = kFar;
+    for (int q = 1; q < n; q++) {
+        float s = ((f[q] + float(q) * q) - (f[v[k]] + float(v[k]) * v[k])) / float(2 * q - 2 * v[k]);
+        while (s <= z[k]) {
+            k--;
+            s = ((f[q] + float(q) * q) - (f[v[k]] + float(v[k]) * v[k])) / float(2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kFar;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < float(q)) k++;
+        float delta = float(q - v[k]);
+        d[q] = delta * delta + f[v[k]];
+    }
+}
+
+// 先按列再按行，grid 中 0 为特征点，其余为 kFar；各列（各行）互不相关，分块并行
+void DistanceTransform2D(std::vector<float>& grid, int width, int height)
+{
+    JobSystem& jobs = JobSystem::Shared();
+    const int n = std::max(width, height);
+    auto columns = [&grid, width, height, n](size_t begin, size_t end) {
+        std::vector<float> f(n), d(n), z(n + 1);
+        std::vector<int> v(n);
+        for (int x = int(begin); x < int(end); x++) {
+            for (int y = 0; y < height; y++) f[y] = grid[size_t(y) * width + x];
+            DistanceTransform1D(f.data(), height, d.data(), v.data(), z.data());
+            for (int y = 0; y < height; y++) grid[size_t(y) * width + x] = d[y];
+        }
+    };
+    auto rows = [&grid, width, n](size_t begin, size_t end) {
+        std::vector<float> d(n), z(n + 1);
+        std::vector<int> v(n);
+        for (int y = int(begin); y < int(end); y++) {
+            float* row = grid.data() + size_t(y) * width;
+            DistanceTransform1D(row, width, d.data(), v.data(), z.data());
+            std::copy(d.begin(), d.begin() + width, row);
+        }
+    };
+    jobs.ParallelFor(0, size_t(width), columns, kMinTexelsPerJob / size_t(std::max(height, 1)));
+    jobs.ParallelFor(0, size_t(height), rows, kMinTexelsPerJob / size_t(std::max(width, 1)));
+}
+
+}
+
+SDFAtlas::SDFAtlas()
+    : m_texture(0), m_pageSize(0), m_fragmented(false)
+{
+}
+
+SDFAtlas::~SDFAtlas()
+{
+    Cleanup();
+}
+
+bool SDFAtlas::Initialize(int pageSize, int maxPages)
+{
+    if (pageSize <= 0 || maxPages <= 0) {
+        std::cout << "SDFAtlas: Invalid atlas size!" << std::endl;
+        return false;
+    }
+
+    m_pageSize = pageSize;
+    m_pages.resize(maxPages);
+    for (Page& page : m_pages) {
+        ResetPage(page);
+    }
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, pageSize, pageSize, maxPages, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
+
+void SDFAtlas::Cleanup()
+{
+    if (m_texture) {
+        glDeleteTextures(1, &m_texture);
+        m_texture = 0;
+    }
+    m_pages.clear();
+    m_entries.clear();
+    m_freeEntries.clear();
+}
+
+void SDFAtlas::ResetPage(Page& page)
+{
+    page.skyline.assign(1, Segment{ 0, 0, m_pageSize });
+    page.freeRects.clear();
+    page.entryCount = 0;
+}
+
+void SDFAtlas::BuildField(const uint8_t* mask, int width, int height, std::vector<uint8_t>& field)
+{
+    const int fieldWidth = width + 2 * kSpread;
+    const int fieldHeight = height + 2 * kSpread;
+    const size_t count = size_t(fieldWidth) * fieldHeight;
+
+    // outside：到最近内部像素的平方距离；inside：到最近外部像素的平方距离
+    std::vector<float> outside(count), inside(count);
+    for (int y = 0; y < fieldHeight; y++) {
+        for (int x = 0; x < fieldWidth; x++) {
+            int mx = x - kSpread;
+            int my = y - kSpread;
+            bool in = mx >= 0 && my >= 0 && mx < width && my < height && mask[size_t(my) * width + mx] != 0;
+            outside[size_t(y) * fieldWidth + x] = in ? 0.0f : kFar;
+            inside[size_t(y) * fieldWidth + x] = in ? kFar : 0.0f;
+        }
+    }
+    // 内外两个变换互不依赖，一个交给作业系统，另一个在本线程执行
+    JobSystem& jobs = JobSystem::Shared();
+    JobCounter outsideDone;
+    jobs.Run([&outside, fieldWidth, fieldHeight]() {
+        DistanceTransform2D(outside, fieldWidth, fieldHeight);
+    }, &outsideDone);
+    DistanceTransform2D(inside, fieldWidth, fieldHeight);
+    jobs.Wait(outsideDone);
+
+    // 像素中心到边界还差半个像素
+    field.resize(count);
+    uint8_t* out = field.data();
+    jobs.ParallelFor(0, count, [&outside, &inside, out](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            float distance = outside[i] > 0.0f ? std::sqrt(outside[i]) - 0.5f : 0.5f - std::sqrt(inside[i]);
+            float value = 0.5f + distance / (2.0f * kSpread);
+            out[i] = uint8_t(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+        }
+    }, kMinTexelsPerJob);
+}
+
+SDFAtlasEntry SDFAtlas::InsertMask(const uint8_t* mask, int width, int height)
+{
+    BuildField(mask, width, height, m_scratch);
+    return Insert(m_scratch.data(), width + 2 * kSpread, height + 2 * kSpread);
+}
+
+SDFAtlasEntry SDFAtlas::Insert(const uint8_t* field, int width, int height)
+{
+    if (!m_texture || width <= 0 || height <= 0) return kInvalidSDFAtlasEntry;
+
+    // 多留一个纹素的间隔，线性过滤不会读到相邻条目
+    int page;
+    Rect rect;
+    bool allocated = Allocate(width + 1, height + 1, page, rect);
+    if (!allocated && m_fragmented) {
+        Repack();
+        allocated = Allocate(width + 1, height + 1, page, rect);
+    }
+    if (!allocated) {
+        std::cout << "SDFAtlas: No space for " << width << "x" << height << " field" << std::endl;
+        return kInvalidSDFAtlasEntry;
+    }
+    m_pages[page].entryCount++;
+
+    SDFAtlasEntry entry;
+    if (!m_freeEntries.empty()) {
+        entry = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    } else {
+        entry = SDFAtlasEntry(m_entries.size());
+        m_entries.push_back(Entry());
+    }
+    Entry& inserted = m_entries[entry];
+    inserted.page = page;
+    inserted.rect = { rect.x, rect.y, width, height };
+    inserted.inUse = true;
+    inserted.field.assign(field, field + size_t(width) * height);
+    Upload(inserted);
+    return entry;
+}
+
+void SDFAtlas::Upload(const Entry& entry) const
+{
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, entry.rect.x, entry.rect.y, entry.page,
+                    entry.rect.width, entry.rect.height, 1, GL_RED, GL_UNSIGNED_BYTE, entry.field.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void SDFAtlas::Repack()
+{
+    // 从高到低依次放入清空的页，skyline 对按高度排序的输入最紧凑
+    std::vector<SDFAtlasEntry> order;
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (m_entries[i].inUse) order.push_back(SDFAtlasEntry(i));
+    }
+    std::sort(order.begin(), order.end(), [this](SDFAtlasEntry a, SDFAtlasEntry b) {
+        return m_entries[a].rect.height > m_entries[b].rect.height;
+    });
+    for (Page& page : m_pages) {
+        ResetPage(page);
+    }
+    m_fragmented = false;
+
+    for (SDFAtlasEntry index : order) {
+        Entry& entry = m_entries[index];
+        Rect rect;
+        if (!Allocate(entry.rect.width + 1, entry.rect.height + 1, entry.page, rect)) {
+            std::cout << "SDFAtlas: Entry " << index << " lost while repacking" << std::endl;
+            entry.inUse = false;
+            entry.field.clear();
+            m_freeEntries.push_back(index);
+            continue;
+        }
+        m_pages[entry.page].entryCount++;
+        entry.rect.x = rect.x;
+        entry.rect.y = rect.y;
+        Upload(entry);
+    }
+}
+
+void SDFAtlas::Remove(SDFAtlasEntry entry)
+{
+    if (!IsValid(entry)) return;
+
+    Entry& removed = m_entries[entry];
+    Page& page = m_pages[removed.page];
+    if (--page.entryCount == 0) {
+        ResetPage(page);
+    } else {
+        Rect rect = removed.rect;
+        rect.width++;
+        rect.height++;
+        page.freeRects.push_back(rect);
+        m_fragmented = true;
+    }
+    removed.inUse = false;
+    removed.field.clear();
+    removed.field.shrink_to_fit();
+    m_freeEntries.push_back(entry);
+}
+
+bool SDFAtlas::IsValid(SDFAtlasEntry entry) const
+{
+    return entry >= 0 && size_t(entry) < m_entries.size() && m_entries[entry].inUse;
+}
+
+glm::vec4 SDFAtlas::GetUVRect(SDFAtlasEntry entry) const
+{
+    const Rect& rect = m_entries[entry].rect;
+    float scale = 1.0f / float(m_pageSize);
+    return glm::vec4((rect.x + 0.5f) * scale, (rect.y + 0.5f) * scale,
+                     (rect.x + rect.width - 0.5f) * scale, (rect.y + rect.height - 0.5f) * scale);
+}
+
+bool SDFAtlas::Allocate(int width, int height, int& page, Rect& rect)
+{
+    if (width > m_pageSize || height > m_pageSize) return false;
+
+    // 先填已有页的空位，再在已有页的 skyline 上放置，最后才启用空页
+    for (size_t i = 0; i < m_pages.size(); i++) {
+        if (m_pages[i].entryCount > 0 && AllocateFromFree(m_pages[i], width, height, rect)) {
+            page = int(i);
+            return true;
+        }
+    }
+    for (size_t i = 0; i < m_pages.size(); i++) {
+        if (m_pages[i].entryCount > 0 && AllocateFromSkyline(m_pages[i], width, height, rect)) {
+            page = int(i);
+            return true;
+        }
+    }
+    for (size_t i = 0; i < m_pages.size(); i++) {
+        if (m_pages[i].entryCount == 0 && AllocateFromSkyline(m_pages[i], width, height, rect)) {
+            page = int(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SDFAtlas::AllocateFromFree(Page& page, int width, int height, Rect& rect)
+{
+    // 短边余量最小者优先
+    int best = -1;
+    int bestShortSide = 0;
+    for (size_t i = 0; i < page.freeRects.size(); i++) {
+        const Rect& space = page.freeRects[i];
+        if (space.width < width || space.height < height) continue;
+        int shortSide = std::min(space.width - width, space.height - height);
+        if (best < 0 || shortSide < bestShortSide) {
+            best = int(i);
+            bestShortSide = shortSide;
+        }
+    }
+    if (best < 0) return false;
+
+    Rect space = page.freeRects[best];
+    page.freeRects[best] = page.freeRects.back();
+    page.freeRects.pop_back();
+    rect = { space.x, space.y, width, height };
+
+    // 沿余量较大的方向切出更大的一块
+    Rect right, top;
+    if (space.width - width > space.height - height) {
+        right = { space.x + width, space.y, space.width - width, space.height };
+        top = { space.x, space.y + height, width, space.height - height };
+    } else {
+        right = { space.x + width, space.y, space.width - width, height };
+        top = { space.x, space.y + height, space.width, space.height - height };
+    }
+    if (right.width > 0 && right.height > 0) page.freeRects.push_back(right);
+    if (top.width > 0 && top.height > 0) page.freeRects.push_back(top);
+    return true;
+}
+
+bool SDFAtlas::FitSkyline(const Page& page, size_t index, int width, int height, int& y) const
+{
+    int x = page.skyline[index].x;
+    if (x + width > m_pageSize) return false;
+
+    y = 0;
+    int remaining = width;
+    for (size_t i = index; remaining > 0; i++) {
+        y = std::max(y, page.skyline[i].y);
+        if (y + height > m_pageSize) return false;
+        remaining -= page.skyline[i].width;
+    }
+    return true;
+}
+
+bool SDFAtlas::AllocateFromSkyline(Page& page, int width, int height, Rect& rect)
+{
+    // bottom-left：放置后顶端最低者优先，相同则选更窄的段
+    int bestIndex = -1;
+    int bestTop = 0;
+    int bestWidth = 0;
+    for (size_t i = 0; i < page.skyline.size(); i++) {
+        int y;
+        if (!FitSkyline(page, i, width, height, y)) continue;
+        int top = y + height;
+        if (bestIndex < 0 || top < bestTop || (top == bestTop && page.skyline[i].width < bestWidth)) {
+            bestIndex = int(i);
+            bestTop = top;
+            bestWidth = page.skyline[i].width;
+            rect = { page.skyline[i].x, y, width, height };
+        }
+    }
+    if (bestIndex < 0) return false;
+
+    // 新段覆盖 [x, x + width)，之后被覆盖的段截短或删除
+    std::vector<Segment>& skyline = page.skyline;
+    Segment segment = { rect.x, rect.y + height, width };
+    skyline.insert(skyline.begin() + bestIndex, segment);
+    for (size_t i = bestIndex + 1; i < skyline.size(); ) {
+        int end = segment.x + segment.width;
+        if (skyline[i].x >= end) break;
+        int shrink = end - skyline[i].x;
+        if (shrink >= skyline[i].width) {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        break;
+    }
+    for (size_t i = 0; i + 1 < skyline.size(); ) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
@@ -3,22 +3,16 @@
 #include <iostream>
 
 SDFGenerator::SDFGenerator() 
-    : m_fbo(0), m_sdfTexture(0), m_vao(0), m_vbo(0), m_shaderProgram(0)
-    , m_width(0), m_height(0) {
+    : m_format(SDFFormat::R16F), m_vbo(0), m_shaderProgram(0)
+    , m_sourceLocation(-1), m_resolutionLocation(-1), m_thresholdLocation(-1) {
 }
 
 SDFGenerator::~SDFGenerator() {
     Cleanup();
 }
 
-bool SDFGenerator::Initialize(int width, int height) {
-    m_width = width;
-    m_height = height;
-    
-    if (!CreateFramebuffer()) {
-        return false;
-    }
-    
+bool SDFGenerator::Initialize(SDFFormat format) {
+    m_format = format;
     if (!CreateQuad()) {
         return false;
     }
@@ -27,29 +21,10 @@ bool SDFGenerator::Initialize(int width, int height) {
         return false;
     }
     
-    return true;
-}
-
-bool SDFGenerator::CreateFramebuffer() {
-    glGenFramebuffers(1, &m_fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-    
-    glGenTextures(1, &m_sdfTexture);
-    glBindTexture(GL_TEXTURE_2D, m_sdfTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_sdfTexture, 0);
-    
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cout << "SDFGenerator: Framebuffer is not complete!" << std::endl;
-        Cleanup();
-        return false;
-    }
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // 编译器会去掉未使用的 uniform，位置为 -1 说明着色器不采样输入纹理
+    m_sourceLocation = glGetUniformLocation(m_shaderProgram, "backgroundTexture");
+    m_resolutionLocation = glGetUniformLocation(m_shaderProgram, "resolution");
+    m_thresholdLocation = glGetUniformLocation(m_shaderProgram, "threshold");
     return true;
 }
 
@@ -64,25 +39,24 @@ bool SDFGenerator::CreateQuad() {
          1.0f,  1.0f,  1.0f, 1.0f
     };
     
-    glGenVertexArrays(1, &m_vao);
     glGenBuffers(1, &m_vbo);
-    
-    glBindVertexArray(m_vao);
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
+    GLuint vbo = m_vbo;
+    m_vao.Initialize([vbo]() {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+    });
     return true;
 }
 
 bool SDFGenerator::LoadShaders() {
     try {
-        Shader sdfShader("shaders/sdf_generator.vert", "shaders/sdf_generator.frag");
+        Shader sdfShader("shaders/sdf_generator.vert", "shaders/sdf_generator.frag", GetShaderDefines(m_format));
         m_shaderProgram = sdfShader.ID;
         return true;
     } catch (const std::exception& e) {
@@ -90,7 +64,7 @@ bool SDFGenerator::LoadShaders() {
         
         try {
             Shader sdfShader("C:/Users/lbd111/LiquidGlassDemo01/shaders/sdf_generator.vert", 
-                             "C:/Users/lbd111/LiquidGlassDemo01/shaders/sdf_generator.frag");
+                             "C:/Users/lbd111/LiquidGlassDemo01/shaders/sdf_generator.frag", GetShaderDefines(m_format));
             m_shaderProgram = sdfShader.ID;
             return true;
         } catch (const std::exception& e2) {
@@ -100,65 +74,68 @@ bool SDFGenerator::LoadShaders() {
     }
 }
 
-void SDFGenerator::GenerateFromTexture(GLuint inputTexture, float threshold) {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-    glViewport(0, 0, m_width, m_height);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    
-    glUseProgram(m_shaderProgram);
-    glUniform1i(glGetUniformLocation(m_shaderProgram, "backgroundTexture"), 0);
-    glUniform2f(glGetUniformLocation(m_shaderProgram, "resolution"), (float)m_width, (float)m_height);
-    glUniform1f(glGetUniformLocation(m_shaderProgram, "threshold"), threshold);
-    
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, inputTexture);
-    
-    glBindVertexArray(m_vao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+int SDFGenerator::ResolutionForFootprint(float diameterPixels) {
+    int resolution = kMinResolution;
+    while (resolution < kMaxResolution && float(resolution) < diameterPixels) {
+        resolution *= 2;
+    }
+    return resolution;
 }
 
-void SDFGenerator::SetSize(int width, int height) {
-    if (m_fbo) {
-        glDeleteFramebuffers(1, &m_fbo);
-        m_fbo = 0;
-    }
-    if (m_sdfTexture) {
-        glDeleteTextures(1, &m_sdfTexture);
-        m_sdfTexture = 0;
+SDFFormat SDFGenerator::FormatForQuality(SDFQuality quality) {
+    switch (quality) {
+    case SDFQuality::Low:    return SDFFormat::R8;
+    case SDFQuality::Medium: return SDFFormat::RG8;
+    default:                 return SDFFormat::R16F;
     }
-    if (m_vao) {
-        glDeleteVertexArrays(1, &m_vao);
-        m_vao = 0;
+}
+
+GLenum SDFGenerator::GetInternalFormat(SDFFormat format) {
+    switch (format) {
+    case SDFFormat::R16F: return GL_R16F;
+    case SDFFormat::RG8:  return GL_RG8;
+    case SDFFormat::R8:   return GL_R8;
+    default:              return GL_RGBA8;
     }
-    if (m_vbo) {
-        glDeleteBuffers(1, &m_vbo);
-        m_vbo = 0;
+}
+
+const char* SDFGenerator::GetShaderDefines(SDFFormat format) {
+    switch (format) {
+    case SDFFormat::R16F: return "#define SDF_FORMAT_R16F\n";
+    case SDFFormat::RG8:  return "#define SDF_FORMAT_RG8\n";
+    case SDFFormat::R8:   return "#define SDF_FORMAT_R8\n";
+    default:              return "#define SDF_FORMAT_RGBA8\n";
     }
-    
-    m_width = width;
-    m_height = height;
-    
-    CreateFramebuffer();
-    CreateQuad();
+}
+
+RenderResource SDFGenerator::AddPass(RenderGraph& graph, RenderResource source, int resolution, float threshold) const {
+    RenderTextureDesc desc = { resolution, resolution, GetInternalFormat(m_format) };
+    RenderResource sdf = graph.CreateTexture("SDF", desc);
+
+    const SDFGenerator* generator = this;
+    graph.AddPass("SDFGenerator", [=](const RenderPassContext& context) {
+        context.BindTarget();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glUseProgram(generator->m_shaderProgram);
+        glUniform1i(generator->m_sourceLocation, 0);
+        glUniform2f(generator->m_resolutionLocation, (float)desc.width, (float)desc.height);
+        glUniform1f(generator->m_thresholdLocation, threshold);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, generator->m_sourceLocation >= 0 ? context.GetTexture(source) : 0);
+
+        generator->m_vao.Bind();
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        glBindVertexArray(0);
+    }).Read(m_sourceLocation >= 0 ? source : kInvalidRenderResource).Write(sdf);
+
+    return sdf;
 }
 
 void SDFGenerator::Cleanup() {
-    if (m_fbo) {
-        glDeleteFramebuffers(1, &m_fbo);
-        m_fbo = 0;
-    }
-    if (m_sdfTexture) {
-        glDeleteTextures(1, &m_sdfTexture);
-        m_sdfTexture = 0;
-    }
-    if (m_vao) {
-        glDeleteVertexArrays(1, &m_vao);
-        m_vao = 0;
-    }
+    m_vao.Cleanup();
     if (m_vbo) {
         glDeleteBuffers(1, &m_vbo);
         m_vbo = 0;
@@ -1,6 +1,22 @@
 #include "Shader.h"
 
+namespace {
+
+void InsertDefines(std::string& code, const char* defines)
+{
+    if (!defines || !*defines) return;
+    size_t lineEnd = code.compare(0, 8, "#version") == 0 ? code.find('\n') : std::string::npos;
+    code.insert(lineEnd == std::string::npos ? 0 : lineEnd + 1, defines);
+}
+
+}
+
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
+    : Shader(vertexPath, fragmentPath, nullptr)
+{
+}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* defines)
 {
     std::string vertexCode;
     std::string fragmentCode;
@@ -28,6 +44,8 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
     }
+    InsertDefines(vertexCode, defines);
+    InsertDefines(fragmentCode, defines);
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
@@ -0,0 +1,239 @@
+#include "TextureContainer.h"
+#include "BlockCompressor.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[4] = { 'L', 'G', 'T', 'X' };
+
+uint64_t AlignUp(uint64_t value)
+{
+    return (value + kTextureContainerAlignment - 1) & ~uint64_t(kTextureContainerAlignment - 1);
+}
+
+void Downsample(const unsigned char* src, uint32_t srcWidth, uint32_t srcHeight,
+                unsigned char* dst, uint32_t dstWidth, uint32_t dstHeight, uint32_t channels)
+{
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        uint32_t y0 = std::min(y * 2, srcHeight - 1);
+        uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            uint32_t x0 = std::min(x * 2, srcWidth - 1);
+            uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+            for (uint32_t c = 0; c < channels; c++) {
+                uint32_t sum = src[(size_t(y0) * srcWidth + x0) * channels + c]
+                             + src[(size_t(y0) * srcWidth + x1) * channels + c]
+                             + src[(size_t(y1) * srcWidth + x0) * channels + c]
+                             + src[(size_t(y1) * srcWidth + x1) * channels + c];
+                dst[(size_t(y) * dstWidth + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+}
+
+TextureContainer::TextureContainer()
+    : m_data(nullptr), m_size(0), m_header(nullptr), m_levels(nullptr)
+#ifdef _WIN32
+    , m_fileHandle(nullptr), m_mappingHandle(nullptr)
+#else
+    , m_fd(-1)
+#endif
+{
+}
+
+TextureContainer::~TextureContainer()
+{
+    Close();
+}
+
+uint32_t TextureContainer::BytesPerPixel(TextureContainerFormat format)
+{
+    return format == TextureContainerFormat::RGB8 ? 3 : 4;
+}
+
+uint64_t TextureContainer::LevelSize(TextureContainerFormat format, uint32_t width, uint32_t height)
+{
+    if (format == TextureContainerFormat::BC1) {
+        return BlockCompressor::BC1Size(width, height);
+    }
+    return uint64_t(width) * height * BytesPerPixel(format);
+}
+
+bool TextureContainer::Open(const std::string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    void* view = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_data = static_cast<const unsigned char*>(view);
+    m_size = size_t(fileSize.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    // 上传是顺序读取，提示内核提前预读
+    madvise(view, size_t(info.st_size), MADV_SEQUENTIAL | MADV_WILLNEED);
+    m_fd = fd;
+    m_data = static_cast<const unsigned char*>(view);
+    m_size = size_t(info.st_size);
+#endif
+
+    m_header = reinterpret_cast<const TextureContainerHeader*>(m_data);
+    if (m_size < sizeof(TextureContainerHeader) ||
+        std::memcmp(m_header->magic, kMagic, sizeof(kMagic)) != 0 ||
+        m_header->version != kTextureContainerVersion ||
+        m_header->format > uint32_t(TextureContainerFormat::BC1) ||
+        m_header->levelCount == 0 || m_header->levelCount > 32 ||
+        m_size < sizeof(TextureContainerHeader) + sizeof(TextureContainerLevel) * m_header->levelCount) {
+        std::cerr << "TextureContainer: Invalid container header: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    m_levels = reinterpret_cast<const TextureContainerLevel*>(m_data + sizeof(TextureContainerHeader));
+    for (uint32_t i = 0; i < m_header->levelCount; i++) {
+        const TextureContainerLevel& level = m_levels[i];
+        if (level.offset > m_size || level.size > m_size - level.offset ||
+            level.size != LevelSize(GetFormat(), level.width, level.height)) {
+            std::cerr << "TextureContainer: Corrupt mip level " << i << ": " << path << std::endl;
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void TextureContainer::Close()
+{
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mappingHandle) CloseHandle(m_mappingHandle);
+    if (m_fileHandle) CloseHandle(m_fileHandle);
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    if (m_data) munmap(const_cast<unsigned char*>(m_data), m_size);
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_levels = nullptr;
+}
+
+bool TextureContainer::Write(const std::string& path, uint32_t width, uint32_t height,
+                             TextureContainerFormat format, const unsigned char* pixels)
+{
+    if (width == 0 || height == 0 || !pixels) return false;
+
+    const uint32_t channels = BytesPerPixel(format);
+
+    std::vector<TextureContainerLevel> levels;
+    uint32_t w = width, h = height;
+    uint64_t offset = 0;
+    for (;;) {
+        TextureContainerLevel level;
+        level.width = w;
+        level.height = h;
+        level.size = LevelSize(format, w, h);
+        level.offset = 0;
+        levels.push_back(level);
+        if (w == 1 && h == 1) break;
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+    }
+
+    offset = AlignUp(sizeof(TextureContainerHeader) + sizeof(TextureContainerLevel) * levels.size());
+    for (TextureContainerLevel& level : levels) {
+        level.offset = offset;
+        offset = AlignUp(offset + level.size);
+    }
+
+    std::vector<unsigned char> data(size_t(offset), 0);
+    TextureContainerHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kTextureContainerVersion;
+    header.width = width;
+    header.height = height;
+    header.format = uint32_t(format);
+    header.levelCount = uint32_t(levels.size());
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), levels.data(), sizeof(TextureContainerLevel) * levels.size());
+
+    if (format == TextureContainerFormat::BC1) {
+        // 先在 RGBA8 上生成 mip 链，再逐级压缩，避免对压缩结果重复降采样
+        std::vector<unsigned char> current(pixels, pixels + size_t(width) * height * channels);
+        std::vector<unsigned char> next;
+        for (size_t i = 0; i < levels.size(); i++) {
+            if (i > 0) {
+                next.resize(size_t(levels[i].width) * levels[i].height * channels);
+                Downsample(current.data(), levels[i - 1].width, levels[i - 1].height,
+                           next.data(), levels[i].width, levels[i].height, channels);
+                current.swap(next);
+            }
+            BlockCompressor::CompressBC1(current.data(), levels[i].width, levels[i].height,
+                                         data.data() + levels[i].offset);
+        }
+    } else {
+        std::memcpy(data.data() + levels[0].offset, pixels, size_t(levels[0].size));
+        for (size_t i = 1; i < levels.size(); i++) {
+            Downsample(data.data() + levels[i - 1].offset, levels[i - 1].width, levels[i - 1].height,
+                       data.data() + levels[i].offset, levels[i].width, levels[i].height, channels);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "TextureContainer: Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return bool(file);
+}
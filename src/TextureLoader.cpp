@@ -1,12 +1,60 @@
 #include "TextureLoader.h"
+#include "TextureContainer.h"
+#include "BlockCompressor.h"
+#include "PNGDecoder.h"
+#include "JobSystem.h"
+#include <algorithm>
 #include <iostream>
+#include <vector>
 #include <stb_image.h>
 
 using namespace std;
 
+namespace {
+
+// BC1 软件解压时每个作业至少处理的块行数
+const size_t kMinBlockRowsPerJob = 8;
+
+// 按 4 像素高的块行分段并行解压，每段当作一张独立的小图交给 DecompressBC1
+void DecompressBC1Parallel(const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgba)
+{
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blockRows = (height + 3) / 4;
+    JobSystem::Shared().ParallelFor(0, blockRows, [=](size_t begin, size_t end) {
+        uint32_t rowBegin = uint32_t(begin) * 4;
+        uint32_t rowEnd = std::min(height, uint32_t(end) * 4);
+        BlockCompressor::DecompressBC1(blocks + begin * blocksX * 8, width, rowEnd - rowBegin,
+                                       rgba + size_t(rowBegin) * width * 4);
+    }, kMinBlockRowsPerJob);
+}
+
+}
+
 GLuint TextureLoader::loadTexture(const std::string& path) {
     GLuint textureID;
     glGenTextures(1, &textureID);
+
+    // PNG 优先走多线程解码器，输出直接是上传格式；JPEG 等格式及 16 位 PNG 仍交给 stb_image
+    PNGImage image;
+    if (PNGDecoder::load(path, 0, image)) {
+        GLenum format = image.channels == 4 ? GL_RGBA : GL_RGB;
+
+        GLint unpackAlignment;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE,
+                     image.pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        return textureID;
+    }
     
     int width, height, nrComponents;
     unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrComponents, 0);
@@ -37,6 +85,66 @@ GLuint TextureLoader::loadTexture(const std::string& path) {
     return textureID;
 }
 
+GLuint TextureLoader::loadTextureContainer(const std::string& path) {
+    TextureContainer container;
+    if (!container.Open(path)) {
+        std::cerr << "Texture container failed to load at path: " << path << std::endl;
+        return 0;
+    }
+
+    TextureContainerFormat containerFormat = container.GetFormat();
+    GLenum format = containerFormat == TextureContainerFormat::RGB8 ? GL_RGB : GL_RGBA;
+    GLuint levelCount = container.GetLevelCount();
+
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+
+    // RGB8 的行宽不一定是 4 字节对齐
+    GLint unpackAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (containerFormat == TextureContainerFormat::BC1 && isBC1Supported()) {
+        for (GLuint level = 0; level < levelCount; level++) {
+            const TextureContainerLevel& info = container.GetLevel(level);
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, info.width, info.height, 0,
+                                   GLsizei(info.size), container.GetLevelData(level));
+        }
+    } else if (containerFormat == TextureContainerFormat::BC1) {
+        // 驱动不支持 S3TC：解压回 RGBA8 上传
+        std::vector<unsigned char> decoded;
+        for (GLuint level = 0; level < levelCount; level++) {
+            const TextureContainerLevel& info = container.GetLevel(level);
+            decoded.resize(size_t(info.width) * info.height * 4);
+            DecompressBC1Parallel(container.GetLevelData(level), info.width, info.height, decoded.data());
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, info.width, info.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                         decoded.data());
+        }
+    } else {
+        for (GLuint level = 0; level < levelCount; level++) {
+            const TextureContainerLevel& info = container.GetLevel(level);
+            glTexImage2D(GL_TEXTURE_2D, level, format, info.width, info.height, 0, format, GL_UNSIGNED_BYTE,
+                         container.GetLevelData(level));
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    return textureID;
+}
+
+bool TextureLoader::isBC1Supported() {
+    return GLEW_EXT_texture_compression_s3tc != 0;
+}
+
 void TextureLoader::deleteTexture(GLuint texture) {
     glDeleteTextures(1, &texture);
 }
\ No newline at end of file
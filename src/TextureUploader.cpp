@@ -0,0 +1,107 @@
+#include "TextureUploader.h"
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+TextureUploader::TextureUploader()
+    : m_context(nullptr), m_nextTicket(kInvalidTicket + 1), m_stopping(false)
+{
+}
+
+TextureUploader::~TextureUploader()
+{
+    Cleanup();
+}
+
+bool TextureUploader::Initialize(GLFWwindow* context)
+{
+    if (!context) {
+        std::cout << "TextureUploader: No shared context, textures will upload on the render thread" << std::endl;
+        return false;
+    }
+    m_context = context;
+    m_stopping = false;
+    m_thread = std::thread(&TextureUploader::WorkerLoop, this);
+    return true;
+}
+
+void TextureUploader::Cleanup()
+{
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_requests.clear();
+    }
+    m_requestReady.notify_all();
+    m_thread.join();
+    m_context = nullptr;
+}
+
+int TextureUploader::Submit(const Upload& upload)
+{
+    int ticket;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ticket = m_nextTicket++;
+        m_requests.push_back({ ticket, upload });
+    }
+    m_requestReady.notify_one();
+    return ticket;
+}
+
+bool TextureUploader::TryTake(int ticket, GLuint& texture)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_completed.size(); i++) {
+        Completed& completed = m_completed[i];
+        if (completed.ticket != ticket) continue;
+
+        // 零超时只查询状态；WAIT_FAILED 时不再等待，避免请求永远取不走
+        if (completed.fence) {
+            GLenum status = glClientWaitSync(completed.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) return false;
+            glDeleteSync(completed.fence);
+        }
+        texture = completed.texture;
+        m_completed[i] = m_completed.back();
+        m_completed.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void TextureUploader::WorkerLoop()
+{
+    glfwMakeContextCurrent(m_context);
+
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestReady.wait(lock, [this]() { return m_stopping || !m_requests.empty(); });
+            if (m_stopping) break;
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        GLuint texture = request.upload();
+        // flush 把栅栏提交给 GPU，渲染上下文中的查询才会最终触发
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_completed.push_back({ request.ticket, texture, fence });
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Completed& completed : m_completed) {
+        if (completed.fence) {
+            glDeleteSync(completed.fence);
+        }
+        if (completed.texture) {
+            glDeleteTextures(1, &completed.texture);
+        }
+    }
+    m_completed.clear();
+    glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,62 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount)
+    : m_activeTasks(0), m_stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < threadCount; i++) {
+        m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskReady.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task, bool urgent) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (urgent) {
+            m_tasks.push_front(std::move(task));
+        } else {
+            m_tasks.push_back(std::move(task));
+        }
+    }
+    m_taskReady.notify_one();
+}
+
+void ThreadPool::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_tasks.empty() && m_activeTasks == 0; });
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskReady.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_activeTasks++;
+        }
+
+        task();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_activeTasks--;
+        if (m_tasks.empty() && m_activeTasks == 0) {
+            m_idle.notify_all();
+        }
+    }
+}
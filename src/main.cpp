@@ -5,24 +5,85 @@
 #include <GLFW/glfw3.h>
 
 #include "LiquidGlass.h"
+#include "GlassPanelLayer.h"
+#include "SDFAtlas.h"
+#include "GlassMeshCache.h"
 #include "BackgroundCapture.h"
 #include "SDFGenerator.h"
 #include "BackgroundRenderer.h"
 #include "Camera.h"
 #include "TextureLoader.h"
+#include "FrameRecorder.h"
+#include "GlassMotion.h"
+#include "FrameAllocator.h"
+#include "RenderGraph.h"
+#include "AllocationCounter.h"
+#include "RenderCommand.h"
+#include "SPSCRing.h"
+#include "DamageTracker.h"
+#include "FramePacer.h"
+#include "ResolutionManager.h"
+#include "ContextVertexArray.h"
+#include "TextureUploader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <atomic>
+#include <thread>
 
 const unsigned int SCR_WIDTH = 1024;
 const unsigned int SCR_HEIGHT = 1536;
+// Capped 色散允许给玻璃 pass 增加的 GPU 耗时（百分比），--profile 退出时据此报告
+const double kDispersionBudgetPercent = 10.0;
 
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
 
 float deltaTime = 0.0f;
-float lastFrame = 0.0f;
 
-LiquidGlass* liquidGlass;
-BackgroundCapture* backgroundCapture;
+// 一个显示面：自己的窗口（上下文）、渲染图和随尺寸变化的状态
+// 着色器程序、背景纹理、SDF 图集、网格与面板层在所有视图上下文的共享组内只有一份；
+// 视图各自只持有 FBO、VAO、屏幕大小的临时纹理与面板分桶结果，显存随视图数亚线性增长
+struct RenderView {
+    GLFWwindow* window;
+    LiquidGlass* glass;
+    BackgroundCapture* capture;
+    RenderGraph* graph;
+    ResolutionManager resolution;
+    GlassPanelLayer::ViewState panelState;
+    DamageTracker damage;
+    glm::mat4 projection;
+    int framebufferWidth;
+    int framebufferHeight;
+    ScreenRect previousGlassDamage;
+    GlassState drawnState;
+    glm::mat4 previousView;
+};
+
+// 主线程创建的窗口及其初始帧缓冲尺寸，第 0 个为主视图
+struct ViewSurface {
+    GLFWwindow* window;
+    int framebufferWidth;
+    int framebufferHeight;
+};
+
+// 以下由渲染线程创建，视图之间共享
 SDFGenerator* sdfGenerator;
 BackgroundRenderer* backgroundRenderer;
+TextureUploader* textureUploader;
+GlassMeshCache* glassMeshCache;
+FrameRecorder* frameRecorder;
+FrameArena* frameArena;
+GlassPanelLayer* glassPanels;
+SDFAtlas* sdfAtlas;
+std::vector<RenderView*> renderViews;
+// 视图与其持有的对象随窗口数创建，活到渲染线程退出，从对象池分配
+PoolAllocator<RenderView, 4> renderViewPool;
+PoolAllocator<LiquidGlass, 4> liquidGlassPool;
+PoolAllocator<BackgroundCapture, 4> backgroundCapturePool;
+PoolAllocator<RenderGraph, 4> renderGraphPool;
+
+std::string recordPath = "capture.y4m";
+int recordFrameLimit = 0;
 
 std::vector<std::string> backgroundFiles = {
     "backgrounds/background.png",
@@ -31,25 +92,95 @@ std::vector<std::string> backgroundFiles = {
 
 size_t currentBackgroundIndex = 0;
 
+// 输入线程（主线程）与渲染线程之间的命令队列；输入线程是唯一生产者
+SPSCRing<RenderCommand, 256> renderCommands;
+// 队列满时暂存，下一次输入处理时按顺序重发
+std::vector<RenderCommand> pendingCommands;
+std::atomic<bool> renderThreadFinished(false);
+
+// 以下只由输入线程读写
+std::vector<GLFWwindow*> viewWindows;
+GlassMotion glassMotion(glm::vec2(0.0f, 0.0f));
+GlassState inputState = { glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f), 0.0, glassMotion.GetStep(),
+                          glm::vec2(0.6f, 0.4f), 20.0f, 30.0f };
+bool inputStateChanged = true;
+
+void postCommand(const RenderCommand& command)
+{
+    if (!pendingCommands.empty() || !renderCommands.TryPush(command)) {
+        pendingCommands.push_back(command);
+    }
+}
+
+void flushCommands()
+{
+    // 状态快照只发送最新的一份
+    if (inputStateChanged) {
+        RenderCommand command = {};
+        command.type = RenderCommandType::UpdateState;
+        command.state = inputState;
+        postCommand(command);
+        inputStateChanged = false;
+    }
+
+    size_t sent = 0;
+    while (sent < pendingCommands.size() && renderCommands.TryPush(pendingCommands[sent])) {
+        sent++;
+    }
+    pendingCommands.erase(pendingCommands.begin(), pendingCommands.begin() + sent);
+}
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
-    if (backgroundRenderer) {
-        backgroundRenderer->SetScreenSize(width, height);
+    RenderCommand command = {};
+    command.type = RenderCommandType::Resize;
+    command.width = width;
+    command.height = height;
+    for (size_t i = 0; i < viewWindows.size(); i++) {
+        if (viewWindows[i] == window) {
+            command.view = int(i);
+        }
+    }
+    postCommand(command);
+}
+
+bool anyWindowShouldClose()
+{
+    for (GLFWwindow* viewWindow : viewWindows) {
+        if (glfwWindowShouldClose(viewWindow)) return true;
     }
+    return false;
 }
 
 void switchBackground()
 {
-    if (!backgroundRenderer) return;
-    
+    RenderCommand command = {};
+    command.type = RenderCommandType::SwitchBackground;
     currentBackgroundIndex = (currentBackgroundIndex + 1) % backgroundFiles.size();
-    backgroundRenderer->LoadBackground(backgroundFiles[currentBackgroundIndex]);
-    std::cout << "Switched to background: " << backgroundFiles[currentBackgroundIndex] << std::endl;
+    command.backgroundIndex = int(currentBackgroundIndex);
+    postCommand(command);
+}
+
+void toggleRecording()
+{
+    RenderCommand command = {};
+    command.type = RenderCommandType::ToggleRecording;
+    postCommand(command);
 }
 
-float g_ref_height = 20.0f;
-float g_ref_length = 30.0f;
+void cyclePacing()
+{
+    RenderCommand command = {};
+    command.type = RenderCommandType::CyclePacing;
+    postCommand(command);
+}
+
+void cycleDispersion()
+{
+    RenderCommand command = {};
+    command.type = RenderCommandType::CycleDispersion;
+    postCommand(command);
+}
 
 void processInput(GLFWwindow* window)
 {
@@ -58,21 +189,24 @@ void processInput(GLFWwindow* window)
     static bool kKeyPressed = false;
     static bool jKeyPressed = false;
     static bool lKeyPressed = false;
+    static bool rKeyPressed = false;
+    static bool cKeyPressed = false;
+    static bool vKeyPressed = false;
     
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
-    glm::vec2 glassPos = liquidGlass->GetGlassPosition();
-    float moveSpeed = 0.02f;
-
+    // 只记录方向，位移由 GlassMotion 按时间积分
+    glm::vec2 direction(0.0f);
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        liquidGlass->SetGlassPosition(glassPos + glm::vec2(0.0f, moveSpeed));
+        direction.y += 1.0f;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        liquidGlass->SetGlassPosition(glassPos + glm::vec2(0.0f, -moveSpeed));
+        direction.y -= 1.0f;
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        liquidGlass->SetGlassPosition(glassPos + glm::vec2(-moveSpeed, 0.0f));
+        direction.x -= 1.0f;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        liquidGlass->SetGlassPosition(glassPos + glm::vec2(moveSpeed, 0.0f));
+        direction.x += 1.0f;
+    glassMotion.SetDirection(direction);
         
     if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS)
     {
@@ -86,13 +220,53 @@ void processInput(GLFWwindow* window)
     {
         bKeyPressed = false;
     }
+
+    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
+    {
+        if (!rKeyPressed)
+        {
+            toggleRecording();
+            rKeyPressed = true;
+        }
+    }
+    else
+    {
+        rKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS)
+    {
+        if (!cKeyPressed)
+        {
+            cycleDispersion();
+            cKeyPressed = true;
+        }
+    }
+    else
+    {
+        cKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS)
+    {
+        if (!vKeyPressed)
+        {
+            cyclePacing();
+            vKeyPressed = true;
+        }
+    }
+    else
+    {
+        vKeyPressed = false;
+    }
     
     if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
     {
         if (!iKeyPressed)
         {
-            g_ref_height += 10.0f;
-            if (g_ref_height > 100.0f) g_ref_height = 100.0f;
+            inputState.refHeight += 10.0f;
+            if (inputState.refHeight > 100.0f) inputState.refHeight = 100.0f;
+            inputStateChanged = true;
             iKeyPressed = true;
         }
     }
@@ -105,8 +279,9 @@ void processInput(GLFWwindow* window)
     {
         if (!kKeyPressed)
         {
-            g_ref_height -= 10.0f;
-            if (g_ref_height < 5.0f) g_ref_height = 5.0f;
+            inputState.refHeight -= 10.0f;
+            if (inputState.refHeight < 5.0f) inputState.refHeight = 5.0f;
+            inputStateChanged = true;
             kKeyPressed = true;
         }
     }
@@ -119,8 +294,9 @@ void processInput(GLFWwindow* window)
     {
         if (!jKeyPressed)
         {
-            g_ref_length -= 10.0f;
-            if (g_ref_length < 5.0f) g_ref_length = 5.0f;
+            inputState.refLength -= 10.0f;
+            if (inputState.refLength < 5.0f) inputState.refLength = 5.0f;
+            inputStateChanged = true;
             jKeyPressed = true;
         }
     }
@@ -133,8 +309,9 @@ void processInput(GLFWwindow* window)
     {
         if (!lKeyPressed)
         {
-            g_ref_length += 10.0f;
-            if (g_ref_length > 100.0f) g_ref_length = 100.0f;
+            inputState.refLength += 10.0f;
+            if (inputState.refLength > 100.0f) inputState.refLength = 100.0f;
+            inputStateChanged = true;
             lKeyPressed = true;
         }
     }
@@ -144,8 +321,538 @@ void processInput(GLFWwindow* window)
     }
 }
 
-int main()
+// 演示用的任意轮廓：五角星与心形，坐标与 GL 纹理一致，y 向上
+void buildDemoShapes(SDFAtlas& atlas, std::vector<SDFAtlasEntry>& entries)
+{
+    const int size = 96;
+    std::vector<uint8_t> star(size * size), heart(size * size);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float px = (x + 0.5f) / size * 2.0f - 1.0f;
+            float py = (y + 0.5f) / size * 2.0f - 1.0f;
+
+            float angle = std::atan2(py, px) + 1.5707963f;
+            float sector = std::fmod(angle + 6.2831853f, 1.2566371f) / 1.2566371f;
+            float starRadius = 0.45f + 0.5f * std::fabs(sector - 0.5f) * 2.0f;
+            star[y * size + x] = std::sqrt(px * px + py * py) < starRadius ? 255 : 0;
+
+            float hx = px * 1.3f;
+            float hy = py * 1.3f + 0.2f;
+            float f = hx * hx + hy * hy - 1.0f;
+            heart[y * size + x] = f * f * f - hx * hx * hy * hy * hy < 0.0f ? 255 : 0;
+        }
+    }
+    for (const std::vector<uint8_t>* mask : { &star, &heart }) {
+        SDFAtlasEntry entry = atlas.InsertMask(mask->data(), size, size);
+        if (entry != kInvalidSDFAtlasEntry) {
+            entries.push_back(entry);
+        }
+    }
+}
+
+// 在可见区域内按固定种子散布静态面板，用于验证大量面板重叠时的分块渲染
+void addDemoPanels(GlassPanelLayer& layer, int count, const std::vector<SDFAtlasEntry>& shapes)
+{
+    unsigned int seed = 12345u;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) / float(1 << 24);
+    };
+    for (int i = 0; i < count; i++) {
+        GlassPanel panel;
+        panel.position = glm::vec2(next() * 1.6f - 0.8f, next() * 2.4f - 1.2f);
+        panel.size = glm::vec2(0.1f + next() * 0.3f, 0.1f + next() * 0.3f);
+        panel.cornerRadius = 0.3f + next() * 0.7f;
+        panel.refHeight = 10.0f + next() * 20.0f;
+        panel.refLength = panel.refHeight + 10.0f + next() * 20.0f;
+        panel.shape = (i % 3 == 0) ? GlassPanelShape::Circle : GlassPanelShape::RoundedRect;
+        panel.atlasEntry = kInvalidSDFAtlasEntry;
+        if (i % 4 == 1 && !shapes.empty()) {
+            panel.shape = GlassPanelShape::Atlas;
+            panel.atlasEntry = shapes[(i / 4) % shapes.size()];
+        }
+        layer.AddPanel(panel);
+    }
+}
+
+// 每个上下文各有一份的渲染状态
+void initializeContextState()
+{
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// 在 surface 的上下文中创建视图；primary 为空时这是主视图，玻璃着色器在这里编译
+RenderView* createRenderView(const ViewSurface& surface, const LiquidGlass* primary, float dispersionStrength)
+{
+    RenderView* view = renderViewPool.Create();
+    view->window = surface.window;
+    view->framebufferWidth = surface.framebufferWidth;
+    view->framebufferHeight = surface.framebufferHeight;
+    view->previousGlassDamage = { 0, 0, 0, 0 };
+    view->drawnState = {};
+    view->previousView = glm::mat4(0.0f);
+    view->projection = glm::mat4(1.0f);
+    view->panelState.resolution = &view->resolution;
+
+    view->capture = backgroundCapturePool.Create();
+    view->capture->Initialize(surface.framebufferWidth, surface.framebufferHeight);
+
+    view->glass = liquidGlassPool.Create();
+    view->glass->SetMeshCache(glassMeshCache);
+    view->glass->SetSDFGenerator(sdfGenerator);
+    // 每个视图都有 SDF 生成器，轮廓由 SDF 决定，4 个顶点的包围四边形即可覆盖
+    view->glass->SetSDFDefinesShape(sdfGenerator != nullptr);
+    if (primary) {
+        view->glass->InitializeShared(*primary);
+    } else {
+        view->glass->Initialize();
+    }
+    view->glass->SetBackgroundCapture(view->capture);
+    view->glass->SetBackgroundRenderer(backgroundRenderer);
+    view->glass->SetDispersion(GlassDispersion::Off, dispersionStrength);
+
+    view->graph = renderGraphPool.Create();
+
+    // 所有随帧缓冲尺寸变化的状态都登记在这里，初始尺寸与之后的每次变化走同一条路径
+    // 视口由各 pass 绑定目标时设置，这里不调用 GL，命令可能在其他视图的上下文中处理
+    view->resolution.AddListener([view](int width, int height) {
+        view->framebufferWidth = width;
+        view->framebufferHeight = height;
+        view->capture->SetScreenSize(width, height);
+        view->glass->SetScreenSize(width, height);
+        view->damage.Reset(width, height);
+        // 最小化时尺寸为 0，保留原来的投影
+        if (width > 0 && height > 0) {
+            view->projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)height, 0.1f, 100.0f);
+        }
+    });
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    view->resolution.Initialize(surface.framebufferWidth, surface.framebufferHeight, maxTextureSize);
+    return view;
+}
+
+// 在视图自己的上下文中调用：FBO 与查询对象属于该上下文
+void destroyRenderView(RenderView* view)
+{
+    renderGraphPool.Destroy(view->graph);
+    liquidGlassPool.Destroy(view->glass);
+    backgroundCapturePool.Destroy(view->capture);
+    renderViewPool.Destroy(view);
+}
+
+// 渲染线程：持有所有视图的 GL 上下文，每帧先取走全部命令，把状态快照合并为一次更新，
+// 再依次切换到各视图的上下文绘制并交换。共享对象在一个上下文中修改后，要等该上下文
+// flush（交换缓冲时隐式进行）才对其他上下文可见，因此共享资源的更新都在主视图的上下文中、
+// 主视图绘制之前完成；同一个程序对象的 uniform 也是共享状态，视图不在多个线程上并发绘制。
+void renderLoop(std::vector<ViewSurface> surfaces, GLFWwindow* loaderWindow,
+                bool compressBackgrounds, bool recordOnStart, int panelCount, float mergeRadius,
+                SDFQuality sdfQuality, float dispersionStrength, bool profile,
+                FramePacing pacing, double targetFps, double refreshRate)
+{
+    GLFWwindow* window = surfaces[0].window;
+    glfwMakeContextCurrent(window);
+
+    if (glewInit() != GLEW_OK)
+    {
+        std::cout << "Failed to initialize GLEW" << std::endl;
+        renderThreadFinished = true;
+        return;
+    }
+
+    initializeContextState();
+
+    // 切换背景时的解码与上传在加载线程的共享上下文中进行；启动时的第一张背景仍同步加载
+    textureUploader = new TextureUploader();
+    textureUploader->Initialize(loaderWindow);
+
+    backgroundRenderer = new BackgroundRenderer();
+    backgroundRenderer->Initialize();
+    backgroundRenderer->SetCompressTextures(compressBackgrounds);
+    backgroundRenderer->SetUploader(textureUploader);
+    backgroundRenderer->LoadBackground(backgroundFiles[0]);
+
+    sdfGenerator = new SDFGenerator();
+    sdfGenerator->Initialize(SDFGenerator::FormatForQuality(sdfQuality));
+
+    glassMeshCache = new GlassMeshCache();
+
+    // 融合模式下可交互的玻璃作为第 0 块面板加入合成距离场，靠近其他面板时与之相连
+    bool mergeGlass = mergeRadius > 0.0f;
+    if (panelCount > 0 || mergeGlass) {
+        glassPanels = new GlassPanelLayer();
+        if (glassPanels->Initialize()) {
+            glassPanels->SetMergeRadius(mergeRadius);
+            if (mergeGlass) {
+                GlassPanel glass = { glm::vec2(0.0f), glm::vec2(0.6f, 0.4f), 1.0f, 20.0f, 30.0f,
+                                     GlassPanelShape::RoundedRect, kInvalidSDFAtlasEntry };
+                glassPanels->AddPanel(glass);
+            }
+            std::vector<SDFAtlasEntry> shapes;
+            sdfAtlas = new SDFAtlas();
+            if (sdfAtlas->Initialize()) {
+                buildDemoShapes(*sdfAtlas, shapes);
+                glassPanels->SetAtlas(sdfAtlas);
+            }
+            addDemoPanels(*glassPanels, panelCount, shapes);
+        } else {
+            delete glassPanels;
+            glassPanels = nullptr;
+            mergeGlass = false;
+        }
+    }
+    // 面板的捕获从后台缓冲拷贝，损伤矩形之外保留的是上一帧已经叠加过面板的画面，跨过矩形边缘的
+    // 静态面板会在边缘内侧采样到它而留下一条带；有静态面板时每帧整帧重绘。
+    // 只有融合的玻璃时它整个落在自己的损伤矩形（含折射与融合余量）内，不受影响
+    bool staticPanels = glassPanels && panelCount > 0;
+
+    renderViews.push_back(createRenderView(surfaces[0], nullptr, dispersionStrength));
+    renderViews[0]->graph->SetProfiling(profile);
+    // 共享对象在主上下文中创建，flush 之后其他上下文才能使用
+    glFlush();
+    for (size_t i = 1; i < surfaces.size(); i++) {
+        glfwMakeContextCurrent(surfaces[i].window);
+        initializeContextState();
+        // 预览不等待垂直同步，否则每个视图的交换各等一次刷新
+        glfwSwapInterval(0);
+        renderViews.push_back(createRenderView(surfaces[i], renderViews[0]->glass, dispersionStrength));
+    }
+    glfwMakeContextCurrent(window);
+
+    frameRecorder = new FrameRecorder();
+    if (recordOnStart) {
+        frameRecorder->Start(recordPath, FrameRecorder::FormatFromPath(recordPath),
+                             renderViews[0]->framebufferWidth, renderViews[0]->framebufferHeight);
+    }
+    int recordedFrames = 0;
+
+    frameArena = new FrameArena();
+
+    // 预热帧之后，除处理一次性命令的帧外，渲染线程每帧都不应发生堆分配
+    const int allocationWarmupFrames = 120;
+    int frameIndex = 0;
+
+    FramePacer framePacer;
+    framePacer.Initialize(refreshRate);
+    framePacer.SetMode(pacing, targetFps);
+
+    GlassState state = {};
+    bool running = true;
+    while (running)
+    {
+        // 先按节奏等待（LowLatency 等 GPU 完成上一帧），再取时间和输入
+        double currentFrame = framePacer.BeginFrame();
+        deltaTime = float(framePacer.GetDeltaTime());
+
+        AllocationScope frameAllocations;
+        bool eventFrame = false;
+        frameArena->BeginFrame();
+
+        // 命令与共享资源的更新在主视图的上下文中进行
+        if (renderViews.size() > 1) {
+            glfwMakeContextCurrent(window);
+        }
+
+        RenderCommand command;
+        bool hasState = false;
+        while (renderCommands.TryPop(command))
+        {
+            switch (command.type)
+            {
+            case RenderCommandType::UpdateState:
+                state = command.state;
+                hasState = true;
+                break;
+            case RenderCommandType::SwitchBackground:
+                eventFrame = true;
+                backgroundRenderer->LoadBackground(backgroundFiles[command.backgroundIndex]);
+                std::cout << "Switched to background: " << backgroundFiles[command.backgroundIndex] << std::endl;
+                break;
+            case RenderCommandType::ToggleRecording:
+                eventFrame = true;
+                if (frameRecorder->IsRecording()) {
+                    frameRecorder->Stop();
+                } else {
+                    frameRecorder->Start(recordPath, FrameRecorder::FormatFromPath(recordPath),
+                                         renderViews[0]->framebufferWidth, renderViews[0]->framebufferHeight);
+                }
+                break;
+            case RenderCommandType::CyclePacing: {
+                eventFrame = true;
+                FramePacing next = FramePacing((int(framePacer.GetMode()) + 1) % int(FramePacing::Count));
+                framePacer.SetMode(next, targetFps);
+                std::cout << "Frame pacing: " << FramePacer::GetModeName(next) << std::endl;
+                break;
+            }
+            case RenderCommandType::CycleDispersion: {
+                eventFrame = true;
+                GlassDispersion current = renderViews[0]->glass->GetDispersion();
+                GlassDispersion next = current == GlassDispersion::Off ? GlassDispersion::Capped :
+                                       current == GlassDispersion::Capped ? GlassDispersion::Full :
+                                       GlassDispersion::Off;
+                for (RenderView* view : renderViews) {
+                    view->glass->SetDispersion(next, dispersionStrength);
+                }
+                std::cout << "Dispersion: " << LiquidGlass::GetPassName(next) << std::endl;
+                break;
+            }
+            case RenderCommandType::Resize:
+                eventFrame = true;
+                renderViews[command.view]->resolution.Resize(command.width, command.height);
+                break;
+            case RenderCommandType::Quit:
+                running = false;
+                break;
+            }
+        }
+        if (!running) break;
+
+        if (backgroundRenderer->Update()) {
+            eventFrame = true;
+        }
+
+        // 插值让画面落后输入一个步长；低延迟模式直接取最新一步的位置
+        double renderTime = framePacer.GetMode() == FramePacing::LowLatency ? currentFrame + state.step : currentFrame;
+        glm::vec2 glassPosition = GlassMotion::Interpolate(state.previousPosition, state.position,
+                                                           state.stepTime, state.step, renderTime);
+        glm::mat4 viewMatrix = camera.GetViewMatrix();
+
+        bool recording = frameRecorder->IsRecording();
+        for (size_t v = 0; v < renderViews.size(); v++) {
+            RenderView& view = *renderViews[v];
+            if (v > 0) {
+                glfwMakeContextCurrent(view.window);
+            }
+            ContextVertexArray::ReleaseOrphans();
+            view.resolution.Update();
+
+            LiquidGlass* liquidGlass = view.glass;
+            if (hasState) {
+                liquidGlass->SetGlassSize(state.size);
+                liquidGlass->SetRefraction(state.refHeight, state.refLength);
+            }
+            // 位置没有变化时 SetGlassPosition 不会使捕获区域失效
+            liquidGlass->SetGlassPosition(glassPosition);
+            liquidGlass->Update(deltaTime);
+
+            DamageTracker& damage = view.damage;
+            if (eventFrame || viewMatrix != view.previousView || staticPanels) {
+                damage.Invalidate();
+            }
+            view.previousView = viewMatrix;
+            if (glassPosition != view.drawnState.position || state.size != view.drawnState.size ||
+                state.refHeight != view.drawnState.refHeight || state.refLength != view.drawnState.refLength) {
+                ScreenRect glassRect = { 0, 0, 0, 0 };
+                if (liquidGlass->GetScreenRect(view.projection, viewMatrix, view.framebufferWidth, view.framebufferHeight, glassRect)) {
+                    float margin = liquidGlass->GetRefractionMargin() + (glassPanels ? glassPanels->GetInfluenceMargin() : 0.0f);
+                    glassRect = DamageTracker::Inflate(glassRect, int(std::ceil(margin)));
+                }
+                damage.AddDamage(DamageTracker::Union(view.previousGlassDamage, glassRect));
+                view.previousGlassDamage = glassRect;
+                view.drawnState = state;
+                view.drawnState.position = glassPosition;
+            }
+            ScreenRect redraw = damage.EndFrame(damage.QueryBufferAge(view.window));
+
+            // 每帧重新声明各 pass 的读写，由渲染图剔除无用 pass 并分配临时纹理
+            RenderGraph* renderGraph = view.graph;
+            renderGraph->BeginFrame(*frameArena);
+            RenderResource backbuffer = renderGraph->ImportBackbuffer(view.framebufferWidth, view.framebufferHeight);
+            if (!damage.IsFullRedraw(redraw)) {
+                renderGraph->SetBackbufferScissor(redraw.x, redraw.y, redraw.width, redraw.height);
+            }
+            renderGraph->AddPass("Clear", [](const RenderPassContext& context) {
+                context.BindTarget();
+                glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            }).Write(backbuffer);
+
+            backgroundRenderer->AddPass(*renderGraph, backbuffer, view.projection, viewMatrix);
+
+            if (mergeGlass) {
+                GlassPanel glass = { glassPosition, state.size, 1.0f, state.refHeight, state.refLength,
+                                     GlassPanelShape::RoundedRect, kInvalidSDFAtlasEntry };
+                glassPanels->SetPanel(0, glass);
+            } else {
+                liquidGlass->AddPasses(*renderGraph, backbuffer, view.projection, viewMatrix);
+            }
+
+            // 面板与着色器在视图间共用，分桶结果写入本视图的 panelState，pass 执行时只读它
+            if (glassPanels) {
+                glassPanels->AddPasses(view.panelState, *renderGraph, backbuffer, view.projection, viewMatrix);
+            }
+
+            if (recording && v == 0) {
+                renderGraph->AddPass("FrameRecorder", [](const RenderPassContext&) {
+                    frameRecorder->CaptureFrame();
+                }).Read(backbuffer).SideEffect();
+            }
+
+            renderGraph->Execute();
+            glfwSwapBuffers(view.window);
+        }
+
+        if (recording) {
+            if (recordFrameLimit > 0 && ++recordedFrames >= recordFrameLimit) {
+                frameRecorder->Stop();
+                running = false;
+                eventFrame = true;
+            }
+        }
+
+        framePacer.EndFrame(window);
+
+        if (++frameIndex > allocationWarmupFrames && !eventFrame) {
+            frameAllocations.ExpectNone("render frame");
+        }
+    }
+    glfwMakeContextCurrent(window);
+
+    for (int i = 0; i < int(FramePacing::Count); i++) {
+        const FrameTimeHistogram& histogram = framePacer.GetHistogram(FramePacing(i));
+        if (histogram.GetCount() == 0) continue;
+        std::cout << "Frame times (" << FramePacer::GetModeName(FramePacing(i)) << "): " << histogram.GetCount()
+                  << " frames, mean " << histogram.GetMean() << " ms, p50 " << histogram.GetPercentile(0.5)
+                  << " ms, p99 " << histogram.GetPercentile(0.99) << " ms, max " << histogram.GetMax() << " ms" << std::endl;
+        for (int b = 0; b < FrameTimeHistogram::kBucketCount; b++) {
+            if (histogram.GetBucket(b) == 0) continue;
+            std::cout << "  " << b * FrameTimeHistogram::kBucketMilliseconds << "-"
+                      << (b + 1) * FrameTimeHistogram::kBucketMilliseconds
+                      << (b == FrameTimeHistogram::kBucketCount - 1 ? "+ ms: " : " ms: ") << histogram.GetBucket(b) << std::endl;
+        }
+    }
+    for (size_t v = 0; v < renderViews.size(); v++) {
+        const RenderView& view = *renderViews[v];
+        if (renderViews.size() > 1) {
+            std::cout << "View " << v << " (" << view.framebufferWidth << "x" << view.framebufferHeight << "): "
+                      << view.graph->GetTextureMemory() / 1024 << " KB of render targets" << std::endl;
+        }
+        if (view.resolution.GetResizeCount() > 0) {
+            std::cout << "Resolution: " << view.resolution.GetResizeCount() << " resizes, "
+                      << view.resolution.GetTargetReallocations() << " render target reallocations" << std::endl;
+        }
+        if (view.damage.GetTotalPixels() > 0.0) {
+            std::cout << "Damage tracking: redrew " << 100.0 * view.damage.GetRedrawnPixels() / view.damage.GetTotalPixels()
+                      << "% of framebuffer pixels" << std::endl;
+        }
+        size_t cacheFrames = view.glass->GetCacheHits() + view.glass->GetCacheMisses();
+        if (cacheFrames > 0) {
+            std::cout << "Glass result cache: " << view.glass->GetCacheHits() << "/" << cacheFrames << " frames hit ("
+                      << 100.0 * view.glass->GetCacheHits() / cacheFrames << "%)" << std::endl;
+        }
+    }
+    RenderGraph* renderGraph = renderViews[0]->graph;
+    if (renderGraph->IsProfiling()) {
+        std::cout << "GPU pass timings:" << std::endl;
+        for (const RenderGraph::PassTiming& timing : renderGraph->GetPassTimings()) {
+            std::cout << "  " << timing.name << ": " << timing.totalMilliseconds / timing.samples << " ms ("
+                      << timing.samples << " frames)" << std::endl;
+        }
+        if (renderGraph->GetDroppedTimingCount() > 0) {
+            std::cout << "  (" << renderGraph->GetDroppedTimingCount() << " samples dropped, results not ready)"
+                      << std::endl;
+        }
+        // 色散相对不开色散的玻璃 pass 增加的耗时，Capped 模式应保持在预算以内
+        double baseTime = renderGraph->GetAveragePassTime(LiquidGlass::GetPassName(GlassDispersion::Off));
+        for (GlassDispersion mode : { GlassDispersion::Capped, GlassDispersion::Full }) {
+            double time = renderGraph->GetAveragePassTime(LiquidGlass::GetPassName(mode));
+            if (baseTime > 0.0 && time > 0.0) {
+                double overhead = 100.0 * (time - baseTime) / baseTime;
+                std::cout << LiquidGlass::GetPassName(mode) << " adds " << overhead << "% to the glass pass";
+                if (mode == GlassDispersion::Capped) {
+                    std::cout << (overhead <= kDispersionBudgetPercent ? " (within " : " (over ")
+                              << kDispersionBudgetPercent << "% budget)";
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+
+    // 预览视图先在各自的上下文中销毁，共享对象最后在主上下文中删除；
+    // 共享对象留在预览上下文中的 VAO 随窗口销毁时一并释放
+    for (size_t v = renderViews.size(); v-- > 1; ) {
+        glfwMakeContextCurrent(renderViews[v]->window);
+        ContextVertexArray::ReleaseOrphans();
+        destroyRenderView(renderViews[v]);
+    }
+    glfwMakeContextCurrent(window);
+    ContextVertexArray::ReleaseOrphans();
+    destroyRenderView(renderViews[0]);
+    renderViews.clear();
+    delete frameArena;
+
+    delete frameRecorder;
+    delete glassPanels;
+    delete sdfAtlas;
+    delete glassMeshCache;
+    delete sdfGenerator;
+    // 先停止加载线程，它在自己的上下文中删除未取走的纹理
+    textureUploader->Cleanup();
+    delete textureUploader;
+    delete backgroundRenderer;
+
+    glfwMakeContextCurrent(NULL);
+    renderThreadFinished = true;
+}
+
+int main(int argc, char** argv)
 {
+    bool recordOnStart = false;
+    bool compressBackgrounds = false;
+    int panelCount = 0;
+    float mergeRadius = 0.0f;
+    SDFQuality sdfQuality = SDFQuality::High;
+    float dispersionStrength = 0.15f;
+    bool profile = false;
+    FramePacing pacing = FramePacing::VSync;
+    double targetFps = 60.0;
+    int viewCount = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+            recordOnStart = true;
+        } else if (arg == "--record-frames" && i + 1 < argc) {
+            recordFrameLimit = std::atoi(argv[++i]);
+        } else if (arg == "--compress-backgrounds") {
+            compressBackgrounds = true;
+        } else if (arg == "--panels" && i + 1 < argc) {
+            panelCount = std::atoi(argv[++i]);
+        } else if (arg == "--merge" && i + 1 < argc) {
+            mergeRadius = float(std::atof(argv[++i]));
+        } else if (arg == "--dispersion" && i + 1 < argc) {
+            dispersionStrength = float(std::atof(argv[++i]));
+        } else if (arg == "--pacing" && i + 1 < argc) {
+            if (!FramePacer::ParseMode(argv[++i], pacing)) {
+                std::cout << "Unknown --pacing " << argv[i] << ", using vsync" << std::endl;
+            }
+        } else if (arg == "--target-fps" && i + 1 < argc) {
+            targetFps = std::atof(argv[++i]);
+        } else if (arg == "--views" && i + 1 < argc) {
+            viewCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--sdf-quality" && i + 1 < argc) {
+            std::string quality = argv[++i];
+            if (quality == "low") {
+                sdfQuality = SDFQuality::Low;
+            } else if (quality == "medium") {
+                sdfQuality = SDFQuality::Medium;
+            } else if (quality == "high") {
+                sdfQuality = SDFQuality::High;
+            } else {
+                std::cout << "Unknown --sdf-quality " << quality << ", using high" << std::endl;
+            }
+        }
+    }
+
+    // 视频流写到标准输出时，把日志改道到标准错误，避免破坏管道数据
+    if (recordOnStart && recordPath == "-") {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -158,73 +865,83 @@ int main()
         glfwTerminate();
         return -1;
     }
-    glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    viewWindows.push_back(window);
 
-    if (glewInit() != GLEW_OK)
-    {
-        std::cout << "Failed to initialize GLEW" << std::endl;
-        return -1;
+    // 预览窗口与主窗口共享上下文对象（纹理、缓冲、着色器程序），各自只有 FBO 与 VAO
+    for (int i = 1; i < viewCount; i++) {
+        std::string title = "Liquid Glass Preview " + std::to_string(i);
+        GLFWwindow* preview = glfwCreateWindow(SCR_WIDTH / 3, SCR_HEIGHT / 3, title.c_str(), NULL, window);
+        if (preview == NULL) {
+            std::cout << "Failed to create preview window " << i << std::endl;
+            break;
+        }
+        glfwSetFramebufferSizeCallback(preview, framebuffer_size_callback);
+        viewWindows.push_back(preview);
     }
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    backgroundRenderer = new BackgroundRenderer();
-    backgroundRenderer->Initialize();
-    backgroundRenderer->LoadBackground("backgrounds/background.png");
-    backgroundRenderer->SetScreenSize(SCR_WIDTH, SCR_HEIGHT);
-
-    backgroundCapture = new BackgroundCapture();
-    backgroundCapture->Initialize(SCR_WIDTH, SCR_HEIGHT);
-
-    sdfGenerator = new SDFGenerator();
-    sdfGenerator->Initialize(SCR_WIDTH, SCR_HEIGHT);
-
-    liquidGlass = new LiquidGlass();
-    liquidGlass->Initialize();
-    liquidGlass->SetBackgroundCapture(backgroundCapture);
-    liquidGlass->SetSDFGenerator(sdfGenerator);
-    liquidGlass->SetBackgroundRenderer(backgroundRenderer);
-    liquidGlass->SetScreenSize(SCR_WIDTH, SCR_HEIGHT);
-    liquidGlass->SetGlassPosition(glm::vec2(0.0f, 0.0f));
-    liquidGlass->SetGlassSize(glm::vec2(0.6f, 0.4f));
+    // 纹理加载线程的上下文：不显示的窗口，与主窗口同一共享组；创建失败时退回同步加载
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* loaderWindow = glfwCreateWindow(1, 1, "Texture Loader", NULL, window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
     
     std::cout << "=== Liquid Glass Demo ===" << std::endl;
     std::cout << "Controls:" << std::endl;
     std::cout << "WASD  : Move liquid glass" << std::endl;
+    std::cout << "R     : Start/stop recording (" << recordPath << ")" << std::endl;
+    std::cout << "C     : Cycle edge dispersion (off / capped / full)" << std::endl;
+    std::cout << "V     : Cycle frame pacing (vsync / adaptive / uncapped / limited / low-latency)" << std::endl;
     std::cout << "ESC   : Exit" << std::endl;
 
-    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-
-    while (!glfwWindowShouldClose(window))
-    {
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        processInput(window);
+    // 窗口查询只能在主线程进行，初始尺寸直接交给渲染线程
+    std::vector<ViewSurface> surfaces;
+    for (GLFWwindow* viewWindow : viewWindows) {
+        ViewSurface surface = { viewWindow, 0, 0 };
+        glfwGetFramebufferSize(viewWindow, &surface.framebufferWidth, &surface.framebufferHeight);
+        surfaces.push_back(surface);
+    }
 
-        liquidGlass->Update(deltaTime);
+    const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    double refreshRate = videoMode ? double(videoMode->refreshRate) : 60.0;
 
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    flushCommands();
+    std::thread renderThread(renderLoop, surfaces, loaderWindow,
+                             compressBackgrounds, recordOnStart, panelCount, mergeRadius, sdfQuality,
+                             dispersionStrength, profile, pacing, targetFps, refreshRate);
 
-        glm::mat4 view = camera.GetViewMatrix();
-        
-        backgroundRenderer->Render(projection, view);
-        
-        liquidGlass->Render(projection, view);
+    // 主线程只处理窗口事件和输入，每个积分步长采样一次键盘，与渲染帧率和 GPU 阻塞无关
+    glassMotion.Advance(glfwGetTime());
+    while (!anyWindowShouldClose() && !renderThreadFinished)
+    {
+        double wait = glassMotion.GetStepTime() + glassMotion.GetStep() - glfwGetTime();
+        if (wait > 0.0) {
+            glfwWaitEventsTimeout(wait);
+            continue;
+        }
 
-        glfwSwapBuffers(window);
         glfwPollEvents();
+        processInput(window);
+
+        // 这一批输入积分出的位置合并为一份快照
+        if (glassMotion.Advance(glfwGetTime()) > 0 &&
+            (glassMotion.GetPosition() != inputState.position ||
+             glassMotion.GetPreviousPosition() != inputState.previousPosition)) {
+            inputState.position = glassMotion.GetPosition();
+            inputState.previousPosition = glassMotion.GetPreviousPosition();
+            inputState.stepTime = glassMotion.GetStepTime();
+            inputStateChanged = true;
+        }
+        flushCommands();
     }
 
-    delete liquidGlass;
-    delete backgroundCapture;
-    delete sdfGenerator;
-    delete backgroundRenderer;
+    RenderCommand quit = {};
+    quit.type = RenderCommandType::Quit;
+    postCommand(quit);
+    while (!renderThreadFinished && !pendingCommands.empty()) {
+        flushCommands();
+        std::this_thread::yield();
+    }
+    renderThread.join();
 
     glfwTerminate();
     return 0;
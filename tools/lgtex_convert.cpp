@@ -0,0 +1,67 @@
+// lgtex_convert：将图像离线转换为预解码的 .lgtex 纹理容器（含完整 mip 链）
+//
+// 用法：lgtex_convert [--rgb | --bc1] <image>...
+// 每个输入在同目录下生成同名 .lgtex，BackgroundRenderer::LoadBackground 会优先加载它。
+// --bc1 以 BC1 块压缩存储（4 bpp），驱动不支持 S3TC 时加载端会解压回 RGBA8。
+
+#include "TextureContainer.h"
+#include <stb_image.h>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    bool rgb = false;
+    bool bc1 = false;
+    int converted = 0;
+    int failed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--rgb") {
+            rgb = true;
+            continue;
+        }
+        if (arg == "--bc1") {
+            bc1 = true;
+            continue;
+        }
+
+        // glTexImage2D 从第一行开始上传，与 TextureLoader::loadTexture 的行序保持一致，不做翻转
+        int width, height, channels;
+        int components = (rgb && !bc1) ? 3 : 4;
+        unsigned char* data = stbi_load(arg.c_str(), &width, &height, &channels, components);
+        if (!data) {
+            std::cerr << "Failed to load " << arg << ": " << stbi_failure_reason() << std::endl;
+            failed++;
+            continue;
+        }
+
+        size_t dot = arg.find_last_of('.');
+        std::string output = (dot == std::string::npos ? arg : arg.substr(0, dot)) + ".lgtex";
+        TextureContainerFormat format = bc1 ? TextureContainerFormat::BC1 :
+                                        (rgb ? TextureContainerFormat::RGB8 : TextureContainerFormat::RGBA8);
+        if (bc1 && channels == 4) {
+            for (size_t p = 3; p < size_t(width) * height * 4; p += 4) {
+                if (data[p] != 255) {
+                    std::cerr << "Warning: " << arg << " has transparent pixels, BC1 drops alpha" << std::endl;
+                    break;
+                }
+            }
+        }
+
+        if (TextureContainer::Write(output, width, height, format, data)) {
+            std::cout << arg << " -> " << output << " (" << width << "x" << height << ")" << std::endl;
+            converted++;
+        } else {
+            failed++;
+        }
+        stbi_image_free(data);
+    }
+
+    if (converted == 0 && failed == 0) {
+        std::cerr << "Usage: lgtex_convert [--rgb | --bc1] <image>..." << std::endl;
+        return 1;
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,337 @@
+// liquidglass_render：离线批量渲染液态玻璃效果
+//
+// 用法：liquidglass_render <manifest.csv|manifest.json> [--threads N] [--out-dir DIR]
+//
+// CSV 第一行为列名，JSON 为对象数组，字段相同：
+//   input, output, x, y, width, height, ref_height, ref_length, border, exposure, scale
+// x/y 为玻璃中心、width/height 为玻璃直径，单位均为输出图像像素（原点左上）。
+
+#include "GlassReferenceRenderer.h"
+#include "ImageWriter.h"
+#include "ThreadPool.h"
+#include <stb_image.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+struct RenderJob {
+    std::string input;
+    std::string output;
+    GlassParams params;
+};
+
+typedef std::map<std::string, std::string> Record;
+
+std::string Trim(const std::string& s)
+{
+    size_t begin = s.find_first_not_of(" \t\r\n\"");
+    size_t end = s.find_last_not_of(" \t\r\n\"");
+    return begin == std::string::npos ? std::string() : s.substr(begin, end - begin + 1);
+}
+
+bool ParseCSV(const std::string& text, std::vector<Record>& records)
+{
+    std::istringstream stream(text);
+    std::string line;
+    std::vector<std::string> header;
+
+    while (std::getline(stream, line)) {
+        if (Trim(line).empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::istringstream lineStream(line);
+        std::string field;
+        while (std::getline(lineStream, field, ',')) {
+            fields.push_back(Trim(field));
+        }
+
+        if (header.empty()) {
+            header = fields;
+            continue;
+        }
+
+        Record record;
+        for (size_t i = 0; i < header.size() && i < fields.size(); i++) {
+            record[header[i]] = fields[i];
+        }
+        records.push_back(record);
+    }
+    return !header.empty();
+}
+
+// 只支持清单所需的子集：对象数组，值为字符串或数字
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : m_text(text), m_pos(0) {}
+
+    bool ParseRecords(std::vector<Record>& records)
+    {
+        if (!Expect('[')) return false;
+        SkipSpace();
+        if (Peek() == ']') return true;
+
+        for (;;) {
+            Record record;
+            if (!ParseObject(record)) return false;
+            records.push_back(record);
+
+            SkipSpace();
+            if (Peek() == ',') { m_pos++; continue; }
+            return Expect(']');
+        }
+    }
+
+private:
+    bool ParseObject(Record& record)
+    {
+        if (!Expect('{')) return false;
+        SkipSpace();
+        if (Peek() == '}') { m_pos++; return true; }
+
+        for (;;) {
+            std::string key, value;
+            if (!ParseString(key) || !Expect(':') || !ParseValue(value)) return false;
+            record[key] = value;
+
+            SkipSpace();
+            if (Peek() == ',') { m_pos++; continue; }
+            return Expect('}');
+        }
+    }
+
+    bool ParseValue(std::string& value)
+    {
+        SkipSpace();
+        if (Peek() == '"') return ParseString(value);
+
+        size_t begin = m_pos;
+        while (m_pos < m_text.size() && (std::isalnum(static_cast<unsigned char>(m_text[m_pos])) ||
+               m_text[m_pos] == '-' || m_text[m_pos] == '+' || m_text[m_pos] == '.')) {
+            m_pos++;
+        }
+        value = m_text.substr(begin, m_pos - begin);
+        return !value.empty();
+    }
+
+    bool ParseString(std::string& value)
+    {
+        if (!Expect('"')) return false;
+        value.clear();
+        while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+            if (m_text[m_pos] == '\\' && m_pos + 1 < m_text.size()) m_pos++;
+            value += m_text[m_pos++];
+        }
+        return Expect('"');
+    }
+
+    bool Expect(char c)
+    {
+        SkipSpace();
+        if (Peek() != c) return false;
+        m_pos++;
+        return true;
+    }
+
+    void SkipSpace()
+    {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) m_pos++;
+    }
+
+    char Peek() const { return m_pos < m_text.size() ? m_text[m_pos] : '\0'; }
+
+    const std::string& m_text;
+    size_t m_pos;
+};
+
+float GetFloat(const Record& record, const char* key, float fallback)
+{
+    auto it = record.find(key);
+    return (it == record.end() || it->second.empty()) ? fallback : float(std::atof(it->second.c_str()));
+}
+
+bool LoadManifest(const std::string& path, const std::string& outDir, std::vector<RenderJob>& jobs)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open manifest: " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    std::vector<Record> records;
+    std::string first = Trim(text.substr(0, text.find_first_not_of(" \t\r\n") + 1));
+    bool ok = first == "[" ? JsonReader(text).ParseRecords(records) : ParseCSV(text, records);
+    if (!ok) {
+        std::cerr << "Failed to parse manifest: " << path << std::endl;
+        return false;
+    }
+
+    GlassParams defaults;
+    for (const Record& record : records) {
+        RenderJob job;
+        auto input = record.find("input");
+        auto output = record.find("output");
+        if (input == record.end() || output == record.end()) {
+            std::cerr << "Skipping manifest entry without input/output" << std::endl;
+            continue;
+        }
+        job.input = input->second;
+        job.output = outDir.empty() ? output->second : outDir + "/" + output->second;
+        job.params.centerX = GetFloat(record, "x", 0.0f);
+        job.params.centerY = GetFloat(record, "y", 0.0f);
+        job.params.width = GetFloat(record, "width", 0.0f);
+        job.params.height = GetFloat(record, "height", job.params.width);
+        job.params.refHeight = GetFloat(record, "ref_height", defaults.refHeight);
+        job.params.refLength = GetFloat(record, "ref_length", defaults.refLength);
+        job.params.borderWidth = GetFloat(record, "border", defaults.borderWidth);
+        job.params.exposure = GetFloat(record, "exposure", defaults.exposure);
+        job.params.scale = GetFloat(record, "scale", defaults.scale);
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+// 单个作业在流水线中的状态：解码 -> 按行段渲染 -> 编码
+struct JobState {
+    const RenderJob* job;
+    GlassReferenceRenderer::RowKernel kernel;
+    RGBAImage source;
+    RGBAImage result;
+    std::atomic<int> pendingBands;
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "Usage: liquidglass_render <manifest.csv|manifest.json> [--threads N] [--out-dir DIR]" << std::endl;
+        return 1;
+    }
+
+    std::string manifestPath = argv[1];
+    std::string outDir;
+    int threadCount = 0;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threadCount = std::atoi(argv[++i]);
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            outDir = argv[++i];
+        }
+    }
+
+    // 输出目录不存在时先创建，创建失败就不必解码和渲染了
+    if (!outDir.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(outDir, error);
+        if (error) {
+            std::cerr << "Failed to create output directory " << outDir << ": " << error.message() << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<RenderJob> jobs;
+    if (!LoadManifest(manifestPath, outDir, jobs)) {
+        return 1;
+    }
+
+    ThreadPool pool(threadCount);
+    const int bandRows = 64;
+    // 同时在途的作业数受限，避免一次性把所有图像解码进内存
+    const int maxInFlight = pool.GetThreadCount() * 2;
+
+    std::mutex mutex;
+    std::condition_variable slotFree;
+    int inFlight = 0;
+    std::atomic<int> failed(0);
+    // 各行段在玻璃核函数内的耗时之和（所有线程累加），不含解码与编码
+    std::atomic<long long> kernelNanoseconds(0);
+
+    auto finishJob = [&](JobState* state) {
+        delete state;
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight--;
+        slotFree.notify_one();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (const RenderJob& job : jobs) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFree.wait(lock, [&] { return inFlight < maxInFlight; });
+            inFlight++;
+        }
+
+        JobState* state = new JobState();
+        state->job = &job;
+        state->kernel = GlassReferenceRenderer::SelectKernel(job.params);
+        state->pendingBands = 0;
+
+        pool.Submit([&, state] {
+            int width, height, channels;
+            unsigned char* data = stbi_load(state->job->input.c_str(), &width, &height, &channels, 4);
+            if (!data) {
+                std::cerr << "Failed to load " << state->job->input << ": " << stbi_failure_reason() << std::endl;
+                failed++;
+                finishJob(state);
+                return;
+            }
+            state->source.width = width;
+            state->source.height = height;
+            state->source.pixels.assign(data, data + size_t(width) * height * 4);
+            stbi_image_free(data);
+            state->result = state->source;
+
+            int rowBegin, rowEnd;
+            GlassReferenceRenderer::GetRowRange(state->job->params, height, rowBegin, rowEnd);
+            int bands = std::max(1, (rowEnd - rowBegin + bandRows - 1) / bandRows);
+            state->pendingBands = bands;
+
+            for (int band = 0; band < bands; band++) {
+                int bandBegin = rowBegin + band * bandRows;
+                int bandEnd = std::min(rowEnd, bandBegin + bandRows);
+                pool.Submit([&, state, bandBegin, bandEnd] {
+                    auto kernelStart = std::chrono::steady_clock::now();
+                    state->kernel(state->source, state->result, state->job->params, bandBegin, bandEnd);
+                    kernelNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - kernelStart).count();
+                    if (--state->pendingBands > 0) return;
+
+                    pool.Submit([&, state] {
+                        if (!ImageWriter::writePNG(state->job->output, state->result.width, state->result.height,
+                                                   4, state->result.pixels.data())) {
+                            failed++;
+                        }
+                        finishJob(state);
+                    }, true);
+                }, true);
+            }
+        });
+    }
+
+    pool.WaitIdle();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int succeeded = int(jobs.size()) - failed;
+    std::cout << "Rendered " << succeeded << "/" << jobs.size() << " images in " << seconds << " s ("
+              << (seconds > 0.0 ? succeeded / seconds : 0.0) << " images/s, "
+              << pool.GetThreadCount() << " threads)" << std::endl;
+    std::cout << "Glass kernel: " << kernelNanoseconds / 1.0e6 << " ms total" << std::endl;
+    return failed > 0 ? 1 : 0;
+}